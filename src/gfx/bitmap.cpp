@@ -33,6 +33,7 @@
 #include "gfx/gfx.h"
 #include "io/trip_io.h"
 #include "util/wutil.h"
+#include "util/arena.h"
 #include <assert.h>
 #include <SDL.h>
 #include <SDL_endian.h>
@@ -111,10 +112,28 @@ Bitmap::Bitmap(const char *image_name, int transparent) {
     uint32_t koko;
     char nimmi[7];
     char longname[12];
-    unsigned char *pointteri2;
-
-    if (dksopen(image_name) == 0) {
+    unsigned char *pointteri2 = NULL;
+    const unsigned char *rle;
+    const uint8_t *entry;
+    int entry_koko;
+
+    // Images in the datafile are decoded straight from the mapped data
+    entry = dksentry(image_name, &entry_koko);
+
+    if (entry != NULL && entry_koko >= 15) {
+        memcpy(&width, entry, sizeof(width));
+        memcpy(&height, entry + 2, sizeof(height));
+        memcpy(&koko, entry + 4, sizeof(koko));
+        memcpy(nimmi, entry + 8, sizeof(nimmi));
+        koko = SDL_SwapLE32(koko);
+
+        if (koko > (uint32_t) (entry_koko - 15)) {
+            printf("Corrupted data %s\n", image_name);
+            exit(1);
+        }
 
+        rle = entry + 15;
+    } else {
         strcpy(longname, image_name);
         strcat(longname, ".pgd");
         dks_faili = fopen(longname, "rb");
@@ -123,40 +142,42 @@ Bitmap::Bitmap(const char *image_name, int transparent) {
             printf("Error opening data %s\n", image_name);
             exit(1);
         }
-    }
 
-    dksread(&width, sizeof(width));
-    dksread(&height, sizeof(height));
-    dksread(&koko, sizeof(koko));
-    dksread(nimmi, sizeof(nimmi));
+        dksread(&width, sizeof(width));
+        dksread(&height, sizeof(height));
+        dksread(&koko, sizeof(koko));
+        dksread(nimmi, sizeof(nimmi));
+        koko = SDL_SwapLE32(koko);
+
+        pointteri2 = (unsigned char *) walloc((unsigned int) koko, WALLOC_BITMAP);
+
+        dksread(pointteri2, koko);
+        dksclose();
+
+        rle = pointteri2;
+    }
 
     width = SDL_SwapLE16(width);
     height = SDL_SwapLE16(height);
-    koko = SDL_SwapLE32(koko);
 
     xx = width;
     yy = height;
 
 
-    image_data = (unsigned char *) walloc(xx * yy);
+    image_data = (unsigned char *) level_alloc(xx * yy, WALLOC_BITMAP);
     external_image_data = 0;
 
-    pointteri2 = (unsigned char *) walloc((unsigned int) koko);
-
-    dksread(pointteri2, koko);
-    dksclose();
-
     lask = 0;
 
     for (lask2 = 0; lask2 < (koko - 1); lask2++) {
 
-        if (pointteri2[lask2] > RLE_REPETITION_MARK) {
-            for (laskx = 1; laskx <= (pointteri2[lask2] - RLE_REPETITION_MARK); laskx++)
-                image_data[lask + laskx - 1] = pointteri2[lask2 + 1];
+        if (rle[lask2] > RLE_REPETITION_MARK) {
+            for (laskx = 1; laskx <= (rle[lask2] - RLE_REPETITION_MARK); laskx++)
+                image_data[lask + laskx - 1] = rle[lask2 + 1];
             lask2++;
             lask += (laskx - 1);
         } else {
-            image_data[lask] = pointteri2[lask2];
+            image_data[lask] = rle[lask2];
             lask++;
 
         }
@@ -168,7 +189,8 @@ Bitmap::Bitmap(const char *image_name, int transparent) {
 
     }
 
-    free(pointteri2);
+    if (pointteri2 != NULL)
+        wfree(pointteri2);
 
     name = image_name;
     hastransparency = transparent;
@@ -187,7 +209,7 @@ Bitmap::Bitmap(int width, int height, unsigned char *image_data, const char *nam
 
 Bitmap::~Bitmap() {
     if (!external_image_data)
-        free(image_data);
+        level_free(image_data);
 }
 
 void Bitmap::blit_fullscreen(void) {
@@ -270,7 +292,7 @@ Bitmap::Bitmap(int x1, int y1, int xl, int yl, Bitmap * source_image) {
     laskx = xl;
     lasky = yl;
 
-    image_data = (unsigned char *) walloc(laskx * lasky);
+    image_data = (unsigned char *) level_alloc(laskx * lasky, WALLOC_BITMAP);
     external_image_data = 0;
 
     lahtopointti = source_image->info(&kokox, &kokoy);
@@ -292,7 +314,7 @@ Bitmap::Bitmap(int x, int y, int w, int h) {
 
     width = w;
     height = h;
-    image_data = (unsigned char *) walloc(w * h);
+    image_data = (unsigned char *) level_alloc(w * h, WALLOC_BITMAP);
     external_image_data = 0;
 
     for (fromy = y, toy = 0; toy < h; fromy++, toy++)
@@ -335,12 +357,12 @@ Bitmap *rotate_bitmap(Bitmap * picture, int degrees) {
     int count, count2;
 
     old_picture_data = picture->info(&xl, &yl);
-    picture_data = (unsigned char *) walloc(xl * yl);
+    picture_data = (unsigned char *) walloc(xl * yl, WALLOC_BITMAP);
 
     nxl = xl << 1;
     nyl = yl << 1;
 
-    temp_data = (unsigned char *) walloc(nxl * nyl);
+    temp_data = (unsigned char *) walloc(nxl * nyl, WALLOC_BITMAP);
 
     for (count = 0; count < (nxl * nyl); count++)
         temp_data[count] = 255;
@@ -357,7 +379,7 @@ Bitmap *rotate_bitmap(Bitmap * picture, int degrees) {
                 = temp_data[(xl + (((count * cosinit[degrees]) - (count2 * sinit[degrees]) + 128) >> 8))
                             + (yl + (((count * sinit[degrees]) + (count2 * cosinit[degrees]) + 128) >> 8)) * nxl];
         }
-    free(temp_data);
+    wfree(temp_data);
 
     return picture2;
 }
@@ -365,10 +387,8 @@ Bitmap *rotate_bitmap(Bitmap * picture, int degrees) {
 int bitmap_exists(const char *name) {
     char longname[80];
 
-    if (dksopen(name)) {
-        dksclose();
+    if (dksentry(name, NULL) != NULL)
         return 1;
-    }
 
     strcpy(longname, name);
     strcat(longname, ".pgd");
@@ -53,14 +53,17 @@ Font::Font(const char *font_name) {
             valiteksti[5] = (char) temp;
             valiteksti[6] = 0;
 
-            if (dksopen(valiteksti)) {
-                dksclose();
+            if (dksentry(valiteksti, NULL) != NULL) {
                 glyphs[temp] = new Bitmap(valiteksti);
                 glyphs[temp]->info(&width, &height);
             } else
                 glyphs[temp] = NULL;
         }
 
+    for (temp = 0; temp < 256; temp++)
+        if (glyphs[temp] != NULL)
+            walloc_retag(glyphs[temp]->info(), WALLOC_FONT);
+
     count_scale();
 }
 
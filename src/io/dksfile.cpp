@@ -34,12 +34,32 @@
 #include "util/msvc.h"
 #else
 #include <unistd.h>
+#include <sys/mman.h>
 #endif
 #include <stdlib.h>
 #include "util/wutil.h"
 #include "io/dksfile.h"
+#include "io/dksformat.h"
+#include "util/compress.h"
 
-#define MAX_ENTRIES 8192
+/*
+ * Directory entry in memory, filled from either datafile version.
+ * koko is the unpacked size. data points to the unpacked entry once
+ * it has been used: straight into the mapped datafile for stored
+ * entries, or to puskuri for packed ones, which stay unpacked until
+ * the datafile is closed.
+ */
+struct dks_entry {
+    char nimi[8];
+    uint32_t offset;
+    uint32_t koko;
+    uint32_t levy_koko;
+    uint32_t pakkaus;
+    uint32_t crc;
+    int tarkista;
+    const uint8_t *data;
+    uint8_t *puskuri;
+};
 
 #pragma pack(1)
 struct main_directory_entry {
@@ -50,7 +70,19 @@ struct main_directory_entry {
 
 #pragma pack()
 
-main_directory_entry *dirri;
+static dks_entry *dirri;
+static int dirri_kpl = 0;
+
+/*
+ * Open addressing hash from entry name to index in dirri, built in
+ * dksinit(). hajautus_koko is a power of two at least twice the number
+ * of entries and unused slots are -1.
+ */
+static int *hajautus = NULL;
+static unsigned int hajautus_koko = 0;
+
+static void dks_unmap(void);
+static void dks_free_directory(void);
 
 class Dirrikka {
   public:
@@ -60,12 +92,12 @@ class Dirrikka {
 };
 
 Dirrikka::Dirrikka(void) {
-    dirri = (main_directory_entry *)
-        walloc(MAX_ENTRIES * sizeof(main_directory_entry));
+    dirri = NULL;
 }
 
 Dirrikka::~Dirrikka() {
-    free(dirri);
+    dks_free_directory();
+    dks_unmap();
 }
 
 Dirrikka dirrikka;
@@ -73,6 +105,20 @@ FILE *dks_faili;
 char dks_tiedosto[FILENAME_MAX];
 int nykyinen_faili;
 
+/*
+ * The whole datafile is mapped (or read, where mmap is not available)
+ * once in dksinit(). Entries opened with dksopen() are then read from
+ * memory at dks_kohta, relative to the start of the entry, and
+ * dks_faili is NULL; dks_faili is only used for plain files opened by
+ * extdksopen() or by the callers themselves.
+ */
+static const uint8_t *dks_data = NULL;
+static long dks_data_koko = 0;
+static int dks_data_mapped = 0;
+static int dks_data_upotettu = 0;
+static const uint8_t *dks_nykyinen = NULL;
+static long dks_kohta;
+
 /*
  * Find absolute path to given datafile. The following paths are tried
  * (in that order):
@@ -113,112 +159,388 @@ static void get_datafile_path(const char *name, char *path) {
     strncpy(path, name, FILENAME_MAX - 1);
 }
 
-int dksinit(const char *tiedosto) {
-
-    char tekstia[20];
+static void dks_unmap(void) {
+    if (dks_data == NULL)
+        return;
 
-    get_datafile_path(tiedosto, dks_tiedosto);
+    if (!dks_data_upotettu) {
+#if !defined(_MSC_VER)
+        if (dks_data_mapped)
+            munmap((void *) dks_data, dks_data_koko);
+        else
+#endif
+            wfree((void *) dks_data);
+    }
 
-    if ((dks_faili = fopen(dks_tiedosto, "rb")) == NULL)
-        return (0);
+    dks_data = NULL;
+    dks_data_koko = 0;
+    dks_data_mapped = 0;
+    dks_data_upotettu = 0;
+}
 
-    fread(tekstia, sizeof(tekstia), 1, dks_faili);
-    fread(dirri, sizeof(main_directory_entry) * MAX_ENTRIES, 1, dks_faili);
+static unsigned int dks_hash(const char *nimi) {
+    unsigned int hash = 2166136261u;
 
-    fclose(dks_faili);
+    while (*nimi)
+        hash = (hash ^ (unsigned char) *nimi++) * 16777619u;
 
-    return (1);
+    return hash;
 }
 
-int dksopen(const char *nimi) {
+static void dks_free_directory(void) {
     int lask;
-    int kohta = -1;
 
-    for (lask = 0; lask < MAX_ENTRIES; lask++) {
-        if (!strcmp(dirri[lask].nimi, nimi)) {
-            kohta = lask;
-            break;
-        }
+    if (dirri != NULL) {
+        for (lask = 0; lask < dirri_kpl; lask++)
+            if (dirri[lask].puskuri != NULL)
+                wfree(dirri[lask].puskuri);
+
+        wfree(dirri);
+        dirri = NULL;
     }
 
-    if (kohta == -1) {
+    if (hajautus != NULL) {
+        wfree(hajautus);
+        hajautus = NULL;
+    }
+
+    dirri_kpl = 0;
+    hajautus_koko = 0;
+    dks_nykyinen = NULL;
+}
+
+/*
+ * Index the entries of dirri by name. If a name appears twice the
+ * first entry wins, as it did with the linear search.
+ */
+static void dks_build_hash(void) {
+    int kohta;
+    unsigned int paikka;
+
+    for (hajautus_koko = 16; hajautus_koko < (unsigned int) dirri_kpl * 2; hajautus_koko <<= 1);
+
+    hajautus = (int *) walloc(hajautus_koko * sizeof(int), WALLOC_DATAFILE);
+    for (paikka = 0; paikka < hajautus_koko; paikka++)
+        hajautus[paikka] = -1;
+
+    for (kohta = 0; kohta < dirri_kpl; kohta++) {
+        for (paikka = dks_hash(dirri[kohta].nimi) & (hajautus_koko - 1); hajautus[paikka] != -1; paikka = (paikka + 1) & (hajautus_koko - 1))
+            if (!strcmp(dirri[hajautus[paikka]].nimi, dirri[kohta].nimi))
+                break;
+
+        if (hajautus[paikka] == -1)
+            hajautus[paikka] = kohta;
+    }
+}
+
+static void dks_allocate_directory(int kpl) {
+    dirri_kpl = kpl;
+    dirri = (dks_entry *) walloc((dirri_kpl ? dirri_kpl : 1) * sizeof(dks_entry), WALLOC_DATAFILE);
+    memset(dirri, 0, (dirri_kpl ? dirri_kpl : 1) * sizeof(dks_entry));
+}
+
+/*
+ * Copy the used entries of a v1 directory to dirri. v1 has no
+ * packing or checksums.
+ */
+static int dks_read_directory_v1(void) {
+    const main_directory_entry *levy = (const main_directory_entry *) (dks_data + DKS_V1_HEADER);
+    int lask, kohta, kpl = 0;
+
+    if (dks_data_koko < (long) (DKS_V1_HEADER + sizeof(main_directory_entry) * DKS_V1_ENTRIES))
+        return 0;
+
+    for (lask = 0; lask < DKS_V1_ENTRIES; lask++)
+        if (levy[lask].nimi[0])
+            kpl++;
+
+    dks_allocate_directory(kpl);
+
+    kohta = 0;
+    for (lask = 0; lask < DKS_V1_ENTRIES; lask++) {
+        if (!levy[lask].nimi[0])
+            continue;
+
+        memcpy(dirri[kohta].nimi, levy[lask].nimi, 6);
+        dirri[kohta].offset = levy[lask].offset;
+        dirri[kohta].koko = levy[lask].koko;
+        dirri[kohta].levy_koko = levy[lask].koko;
+        dirri[kohta].pakkaus = DKS_PAKKAUS_EI;
+        kohta++;
+    }
+
+    return 1;
+}
+
+static int dks_read_directory_v2(void) {
+    const uint8_t *levy;
+    uint32_t kpl, hakemisto;
+    uint32_t lask;
+
+    if (dks_data_koko < DKS_V2_HEADER || dks_get32(dks_data + DKS_V2_H_VERSION) != DKS_V2_VERSION)
+        return 0;
+
+    kpl = dks_get32(dks_data + DKS_V2_H_KPL);
+    hakemisto = dks_get32(dks_data + DKS_V2_H_HAKEMISTO);
+
+    if (hakemisto > (unsigned long) dks_data_koko || kpl > (dks_data_koko - hakemisto) / DKS_V2_ENTRY)
+        return 0;
+
+    dks_allocate_directory(kpl);
+
+    for (lask = 0; lask < kpl; lask++) {
+        levy = dks_data + hakemisto + lask * DKS_V2_ENTRY;
+
+        memcpy(dirri[lask].nimi, levy, 6);
+        dirri[lask].offset = dks_get32(levy + DKS_V2_E_OFFSET);
+        dirri[lask].levy_koko = dks_get32(levy + DKS_V2_E_KOKO);
+        dirri[lask].koko = dks_get32(levy + DKS_V2_E_PURETTU);
+        dirri[lask].pakkaus = dks_get32(levy + DKS_V2_E_PAKKAUS);
+        dirri[lask].crc = dks_get32(levy + DKS_V2_E_CRC);
+        dirri[lask].tarkista = 1;
+    }
+
+    return 1;
+}
+
+static int dks_open_data(void) {
+    int ok;
 
+    if (!memcmp(dks_data, DKS_V2_MAGIC, DKS_V2_MAGIC_KOKO))
+        ok = dks_read_directory_v2();
+    else
+        ok = dks_read_directory_v1();
+
+    if (!ok) {
+        dks_free_directory();
+        dks_unmap();
         return (0);
     }
 
+    dks_build_hash();
+
+    return (1);
+}
+
+int dksinit(const char *tiedosto) {
+    FILE *faili;
+    struct stat st;
+
+    get_datafile_path(tiedosto, dks_tiedosto);
+
+    if ((faili = fopen(dks_tiedosto, "rb")) == NULL)
+        return (0);
 
-    if ((dks_faili = fopen(dks_tiedosto, "rb")) == NULL)
+    if (fstat(fileno(faili), &st) || st.st_size < DKS_V2_HEADER) {
+        fclose(faili);
         return (0);
+    }
 
-    fseek(dks_faili, dirri[kohta].offset, SEEK_SET);
+    dks_free_directory();
+    dks_unmap();
+    dks_data_koko = st.st_size;
 
-    nykyinen_faili = kohta;
+#if !defined(_MSC_VER)
+    void *kartta = mmap(NULL, dks_data_koko, PROT_READ, MAP_PRIVATE, fileno(faili), 0);
 
-    return (1);
+    if (kartta != MAP_FAILED) {
+        dks_data = (const uint8_t *) kartta;
+        dks_data_mapped = 1;
+    }
+#endif
+
+    if (dks_data == NULL) {
+        uint8_t *puskuri = (uint8_t *) walloc(dks_data_koko, WALLOC_DATAFILE);
+
+        if (fread(puskuri, dks_data_koko, 1, faili) != 1) {
+            wfree(puskuri);
+            fclose(faili);
+            dks_data_koko = 0;
+            return (0);
+        }
+
+        dks_data = puskuri;
+    }
+
+    fclose(faili);
+
+    return dks_open_data();
 }
 
-int extdksopen(const char *nimi) {
+/*
+ * Use a datafile that is already in memory, such as one linked into
+ * the executable. The data must stay valid and is never freed.
+ */
+int dksinit_memory(const uint8_t *data, long koko) {
+    if (koko < DKS_V2_HEADER)
+        return (0);
+
+    dks_free_directory();
+    dks_unmap();
+
+    strcpy(dks_tiedosto, "(embedded)");
+    dks_data = data;
+    dks_data_koko = koko;
+    dks_data_upotettu = 1;
+
+    return dks_open_data();
+}
+
+static int dks_find(const char *nimi) {
     int lask;
-    int kohta = -1;
-    int faili = 0;
+    unsigned int paikka;
 
-    for (lask = 0; lask < MAX_ENTRIES; lask++) {
+    if (hajautus == NULL)
+        return -1;
+
+    for (paikka = dks_hash(nimi) & (hajautus_koko - 1); (lask = hajautus[paikka]) != -1; paikka = (paikka + 1) & (hajautus_koko - 1)) {
         if (!strcmp(dirri[lask].nimi, nimi)) {
-            kohta = lask;
-            break;
+            if (dirri[lask].offset > (unsigned long) dks_data_koko || dirri[lask].levy_koko > dks_data_koko - dirri[lask].offset)
+                return -1;
+
+            return lask;
         }
     }
 
-    if (kohta == -1) {
-        dks_faili = fopen(nimi, "rb");
-        faili = 1;
-        if (dks_faili == NULL)
-            return (0);
+    return -1;
+}
+
+/*
+ * Return the unpacked data of an entry, unpacking and checking it the
+ * first time it is used.
+ */
+static const uint8_t *dks_entry_data(int kohta) {
+    dks_entry *entry = &dirri[kohta];
+    const uint8_t *levy;
+
+    if (entry->data != NULL)
+        return entry->data;
+
+    levy = dks_data + entry->offset;
+
+    if (entry->pakkaus == DKS_PAKKAUS_EI) {
+        if (entry->levy_koko != entry->koko) {
+            printf("Corrupted datafile entry %s\n", entry->nimi);
+            exit(1);
+        }
+
+        entry->data = levy;
+    } else if (entry->pakkaus == DKS_PAKKAUS_LZ) {
+        entry->puskuri = (uint8_t *) walloc(entry->koko ? entry->koko : 1, WALLOC_DATAFILE);
+
+        if (!decompress_block(levy, entry->levy_koko, entry->puskuri, entry->koko)) {
+            printf("Corrupted datafile entry %s\n", entry->nimi);
+            exit(1);
+        }
+
+        entry->data = entry->puskuri;
     } else {
-        if ((dks_faili = fopen(dks_tiedosto, "rb")) == NULL)
-            return (0);
+        printf("Unknown packing method in datafile entry %s\n", entry->nimi);
+        exit(1);
+    }
+
+    if (entry->tarkista && checksum_crc32(entry->data, entry->koko) != entry->crc) {
+        printf("Checksum mismatch in datafile entry %s\n", entry->nimi);
+        exit(1);
+    }
+
+    return entry->data;
+}
 
-        fseek(dks_faili, dirri[kohta].offset, SEEK_SET);
+const uint8_t *dksentry(const char *nimi, int *koko) {
+    int kohta = dks_find(nimi);
 
-        nykyinen_faili = kohta;
+    if (kohta == -1)
+        return NULL;
+
+    if (koko != NULL)
+        *koko = dirri[kohta].koko;
+
+    return dks_entry_data(kohta);
+}
+
+int dksopen(const char *nimi) {
+    int kohta = dks_find(nimi);
+
+    if (kohta == -1) {
+
+        return (0);
     }
 
+    dks_faili = NULL;
+    dks_nykyinen = dks_entry_data(kohta);
+    dks_kohta = 0;
+    nykyinen_faili = kohta;
+
     return (1);
 }
 
+int extdksopen(const char *nimi) {
+    if (dksopen(nimi))
+        return (1);
+
+    dks_faili = fopen(nimi, "rb");
+    if (dks_faili == NULL)
+        return (0);
+
+    return (1);
+}
 
 
-void dksclose(void) {
-    fclose(dks_faili);
 
+void dksclose(void) {
+    if (dks_faili != NULL) {
+        fclose(dks_faili);
+        dks_faili = NULL;
+    }
 }
 
 int dkssize(void) {
     return dirri[nykyinen_faili].koko;
 }
 
+int dkscount(void) {
+    return dirri_kpl;
+}
+
+const char *dksname(int numero) {
+    return dirri[numero].nimi;
+}
+
 int dksread(void *mihin, unsigned long int koko) {
-    if (fread(mihin, koko, 1, dks_faili))
-        return 1;
-    else
+    if (dks_faili != NULL) {
+        if (fread(mihin, koko, 1, dks_faili))
+            return 1;
+        else
+            return 0;
+    }
+
+    if (dks_kohta < 0 || dks_kohta > (long) dirri[nykyinen_faili].koko ||
+        koko > (unsigned long) (dirri[nykyinen_faili].koko - dks_kohta))
         return 0;
+
+    memcpy(mihin, dks_nykyinen + dks_kohta, koko);
+    dks_kohta += koko;
+
+    return 1;
 }
 
 int dksseek(int offset, int mode) {
+    if (dks_faili != NULL)
+        return (fseek(dks_faili, offset, mode));
+
     switch (mode) {
     case SEEK_SET:
-        return (fseek(dks_faili, dirri[nykyinen_faili].offset + offset, SEEK_SET));
-        break;
+        dks_kohta = offset;
+        return 0;
 
     case SEEK_CUR:
-        return (fseek(dks_faili, offset, SEEK_CUR));
-        break;
+        dks_kohta += offset;
+        return 0;
 
     case SEEK_END:
-        return (fseek(dks_faili, dirri[nykyinen_faili].offset + dirri[nykyinen_faili].koko + offset, SEEK_SET));
-        break;
-
-
+        dks_kohta = dirri[nykyinen_faili].koko + offset;
+        return 0;
     }
 
 
@@ -226,9 +548,18 @@ int dksseek(int offset, int mode) {
 }
 
 int dksgetc(void) {
-    return (fgetc(dks_faili));
+    if (dks_faili != NULL)
+        return (fgetc(dks_faili));
+
+    if (dks_kohta < 0 || dks_kohta >= (long) dirri[nykyinen_faili].koko)
+        return EOF;
+
+    return dks_nykyinen[dks_kohta++];
 }
 
 long dkstell(void) {
-    return (ftell(dks_faili) - dirri[nykyinen_faili].offset);
+    if (dks_faili != NULL)
+        return (ftell(dks_faili));
+
+    return dks_kohta;
 }
@@ -22,8 +22,11 @@
 #define DKSFILE_H
 
 #include <stdio.h>
+#include <stdint.h>
 
 int dksinit(const char *tiedosto);
+int dksinit_memory(const uint8_t *data, long koko);
+const uint8_t *dksentry(const char *nimi, int *koko);
 int dksopen(const char *nimi);
 int extdksopen(const char *nimi);
 void dksclose(void);
@@ -32,6 +35,8 @@ int dksseek(int offset, int mode);
 int dksgetc(void);
 long dkstell(void);
 int dkssize(void);
+int dkscount(void);
+const char *dksname(int numero);
 
 extern FILE *dks_faili;
 
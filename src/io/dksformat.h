@@ -0,0 +1,80 @@
+/* 
+ * Triplane Classic - a side-scrolling dogfighting game.
+ * Copyright (C) 1996,1997,2009  Dodekaedron Software Creations Oy
+ * 
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * tjt@users.sourceforge.net
+ */
+
+#ifndef DKSFORMAT_H
+#define DKSFORMAT_H
+#include <stdint.h>
+
+/*
+ * On-disk layout of DKS datafiles, shared by the reader and dksbuild.
+ *
+ * v1: 20 byte text header, then DKS_V1_ENTRIES packed entries of
+ * { char nimi[7]; unsigned long offset, koko; } in the native long
+ * size of the machine that built it, then the raw entry data.
+ *
+ * v2: DKS_V2_HEADER byte header, starting with the 16 byte
+ * DKS_V2_MAGIC and followed by little endian uint32 fields
+ * (version, entry count, directory offset), then the directory
+ * of DKS_V2_ENTRY byte entries, then the entry data. Every entry
+ * starts on a DKS_V2_ALIGN byte boundary.
+ */
+
+#define DKS_V1_MAGIC "DKS Datafile\n\032\n"
+#define DKS_V1_HEADER 20
+#define DKS_V1_ENTRIES 8192
+
+#define DKS_V2_MAGIC "DKS Datafile 2\n\032"
+#define DKS_V2_MAGIC_KOKO 16
+#define DKS_V2_VERSION 2
+#define DKS_V2_HEADER 64
+#define DKS_V2_ALIGN 64
+
+/* Header field offsets */
+#define DKS_V2_H_VERSION 16
+#define DKS_V2_H_KPL 20
+#define DKS_V2_H_HAKEMISTO 24
+
+/*
+ * Directory entry: char nimi[8] (NUL padded), then uint32 offset,
+ * stored size, unpacked size, packing method and CRC-32 of the
+ * unpacked data, and a reserved word.
+ */
+#define DKS_V2_ENTRY 32
+#define DKS_V2_E_OFFSET 8
+#define DKS_V2_E_KOKO 12
+#define DKS_V2_E_PURETTU 16
+#define DKS_V2_E_PAKKAUS 20
+#define DKS_V2_E_CRC 24
+
+#define DKS_PAKKAUS_EI 0
+#define DKS_PAKKAUS_LZ 1
+
+static inline uint32_t dks_get32(const uint8_t *p) {
+    return p[0] | (p[1] << 8) | (p[2] << 16) | ((uint32_t) p[3] << 24);
+}
+
+static inline void dks_put32(uint8_t *p, uint32_t arvo) {
+    p[0] = arvo;
+    p[1] = arvo >> 8;
+    p[2] = arvo >> 16;
+    p[3] = arvo >> 24;
+}
+
+#endif
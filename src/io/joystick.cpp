@@ -24,6 +24,7 @@
 #include <string.h>
 #include "sdl_compat.h"
 #include "io/joystick.h"
+#include "io/timing.h"
 #include "settings.h"
 #include "util/wutil.h"
 
@@ -157,6 +158,9 @@ static int is_joystick_action_active(int t, const joystick_action * a) {
  * @param inmenu = 1 if the player is in a menu (e.g. hangar menu)
  */
 void get_joystick_action(int t, int inmenu, int *down, int *up, int *power, int *roll, int *guns, int *bombs) {
+    static int edellinen[2] = { -1, -1 };
+    int tila;
+
     /*
      * Special joystick actions for hangar menu are disabled here because
      * they are unintuitive on gamepads and other non-default joystick
@@ -185,6 +189,12 @@ void get_joystick_action(int t, int inmenu, int *down, int *up, int *power, int
             *up = is_joystick_action_active(t, &joystick_config[t].up);
         }
     }
+
+    // A changed action is input for the latency measurement
+    tila = *down | (*up << 1) | (*power << 2) | (*roll << 3) | (*guns << 4) | (*bombs << 5);
+    if (edellinen[t] != -1 && tila != edellinen[t])
+        input_latency_event(joystick_event_time());
+    edellinen[t] = tila;
 }
 
 /** Does joystick t have a roll button? */
@@ -36,18 +36,50 @@
 #include "util/wutil.h"
 #include "io/timing.h"
 #include "io/video.h"
+#include "io/wavmix.h"
 #include <string.h>
+#include <limits.h>
 
 #if defined (__EMSCRIPTEN__)
 #include <emscripten.h>
 #endif
 
+/*
+ * Keyboard state. SDL events update the live state, indexed by
+ * scancode; update_key_state() then freezes it into the snapshot that
+ * is_key() and friends read until the next call. With -record each
+ * changed snapshot is written to a stream: the snapshots of a
+ * main_engine() run go to record.key, next to record.dta, and all the
+ * others (menus) to record.mnu. With -playback the snapshots are read
+ * back from the same streams instead of the keyboard. Each stream
+ * numbers its snapshots by the update_key_state() calls made while it
+ * was the active one. Esc, Pause and F4 are always taken from the
+ * keyboard too, so that playback can be paused and stopped.
+ */
+#define KEY_WORDS (SDL_NUM_SCANCODES / 32)
+#define KEY_RECORD_SIZE (4 + 2 + KEY_WORDS * 4)
+
+typedef struct
+{
+    uint32_t down[KEY_WORDS];
+    uint16_t last;              /* scancode of the latest key still down */
+} key_snapshot;
+
 typedef struct
 {
-    SDL_Keycode keycode;
-    bool pressed;
-    size_t event_id;
-} Key;
+    int kaytossa;               /* between key_*_start() and key_record_stop() */
+    FILE *record_file;
+    FILE *playback_file;
+    uint32_t frame;
+    key_snapshot edellinen;     /* last snapshot written */
+    key_snapshot toistettu;     /* last snapshot read */
+    uint8_t tietue[KEY_RECORD_SIZE];
+    int tietue_luettu;
+} key_stream;
+
+static const SDL_Scancode live_keys[] = {
+    SDL_SCANCODE_ESCAPE, SDL_SCANCODE_PAUSE, SDL_SCANCODE_F4
+};
 
 namespace
 {
@@ -56,8 +88,16 @@ bool fs_mounted = false;
 bool fs_flushed = false;
 #endif
 
-const size_t MAX_NUMBER_OF_PRESSED_KEYS = 128;
-Key keys[MAX_NUMBER_OF_PRESSED_KEYS] = {{0}};
+uint32_t live_down[KEY_WORDS];
+uint32_t live_event_id[SDL_NUM_SCANCODES];
+uint32_t live_change_time = 0;  /* first change since the last snapshot */
+uint32_t joystick_time = 0;     /* latest joystick event */
+key_snapshot snapshot;
+
+/* Scancode seen for each Latin-1 keycode, 0 until known */
+SDL_Scancode keycode_scancode[256];
+
+key_stream key_streams[2];
 
 void toggle_fullscreen() {
     set_fullscreen(!wantfullscreen);
@@ -160,37 +200,38 @@ int getch(void) {
     }
 }
 
-Key *find_key(SDL_Keycode keycode) {
-    int i;
-    /* Look if key already exists in array */
-    for (i = 0; i < MAX_NUMBER_OF_PRESSED_KEYS; ++i) {
-        if (keys[i].keycode == keycode) {
-            return &keys[i];
-        }
-    }
-    /* Find free entry if key didn't previously exist */
-    for (i = 0; i < MAX_NUMBER_OF_PRESSED_KEYS; ++i) {
-        if (!keys[i].keycode) {
-            return &keys[i];
-        }
-    }
-    /* Out of slots. Should never happen with big enough MAX_NUMBER_OF_PRESSED_KEYS */
-    return NULL;
+static SDL_Scancode key_scancode(SDL_Keycode key) {
+    if (key & SDLK_SCANCODE_MASK)
+        return (SDL_Scancode) (key & ~SDLK_SCANCODE_MASK);
+
+    if (key == SDLK_UNKNOWN)
+        return SDL_SCANCODE_UNKNOWN;
+
+    if (key < 0 || key >= 256)
+        return SDL_GetScancodeFromKey(key);
+
+    if (keycode_scancode[key] == SDL_SCANCODE_UNKNOWN)
+        keycode_scancode[key] = SDL_GetScancodeFromKey(key);
+
+    return keycode_scancode[key];
+}
+
+static bool snapshot_down(int scancode) {
+    if (scancode <= 0 || scancode >= SDL_NUM_SCANCODES)
+        return false;
+
+    return (snapshot.down[scancode >> 5] >> (scancode & 31)) & 1;
 }
 
 bool is_key(SDL_Keycode key) {
-    Key *searched_key = find_key(key);
-    if (searched_key) {
-        return searched_key->pressed;
-    }
-    return false;
+    return snapshot_down(key_scancode(key));
 }
 
 bool is_any_key(void) {
     int i;
 
-    for (i = 0; i < MAX_NUMBER_OF_PRESSED_KEYS; ++i) {
-        if (keys[i].pressed) {
+    for (i = 0; i < KEY_WORDS; ++i) {
+        if (snapshot.down[i]) {
             return true;
         }
     }
@@ -199,22 +240,154 @@ bool is_any_key(void) {
 }
 
 SDL_Keycode last_key(void) {
+    if (!snapshot_down(snapshot.last))
+        return SDLK_UNKNOWN;
+
+    return SDL_GetKeyFromScancode((SDL_Scancode) snapshot.last);
+}
+
+static void freeze_live_keys(void) {
+    uint32_t latest = 0;
+    int i;
+
+    memcpy(snapshot.down, live_down, sizeof(snapshot.down));
+    snapshot.last = 0;
+
+    for (i = 1; i < SDL_NUM_SCANCODES; ++i) {
+        if (((live_down[i >> 5] >> (i & 31)) & 1) && live_event_id[i] >= latest) {
+            latest = live_event_id[i];
+            snapshot.last = i;
+        }
+    }
+}
+
+static uint32_t get_le32(const uint8_t * p) {
+    return p[0] | (p[1] << 8) | (p[2] << 16) | ((uint32_t) p[3] << 24);
+}
+
+static int get_le16(const uint8_t * p) {
+    return p[0] | (p[1] << 8);
+}
+
+static void put_le32(uint8_t * p, uint32_t arvo) {
+    p[0] = arvo;
+    p[1] = arvo >> 8;
+    p[2] = arvo >> 16;
+    p[3] = arvo >> 24;
+}
+
+static void put_le16(uint8_t * p, int arvo) {
+    p[0] = arvo;
+    p[1] = arvo >> 8;
+}
+
+static void write_key_record(key_stream * virta) {
+    uint8_t tietue[KEY_RECORD_SIZE];
     int i;
-    Key *key = NULL;
 
-    for (i = 0; i < MAX_NUMBER_OF_PRESSED_KEYS; ++i) {
-        if (keys[i].pressed && (!key || (keys[i].event_id > key->event_id))) {
-            key = &keys[i];
+    if (virta->frame != 0 && virta->edellinen.last == snapshot.last &&
+        !memcmp(virta->edellinen.down, snapshot.down, sizeof(snapshot.down)))
+        return;
+
+    virta->edellinen = snapshot;
+
+    put_le32(tietue, virta->frame);
+    put_le16(tietue + 4, snapshot.last);
+    for (i = 0; i < KEY_WORDS; i++)
+        put_le32(tietue + 6 + i * 4, snapshot.down[i]);
+
+    fwrite(tietue, KEY_RECORD_SIZE, 1, virta->record_file);
+}
+
+static void read_key_record(key_stream * virta) {
+    int i;
+
+    for (;;) {
+        if (!virta->tietue_luettu) {
+            if (fread(virta->tietue, KEY_RECORD_SIZE, 1, virta->playback_file) != 1)
+                return;
+            virta->tietue_luettu = 1;
+        }
+
+        if (get_le32(virta->tietue) > virta->frame)
+            return;
+
+        virta->toistettu.last = get_le16(virta->tietue + 4);
+        for (i = 0; i < KEY_WORDS; i++)
+            virta->toistettu.down[i] = get_le32(virta->tietue + 6 + i * 4);
+
+        virta->tietue_luettu = 0;
+    }
+}
+
+/* Replayed snapshot with Esc, Pause and F4 from the keyboard */
+static void merge_live_keys(const key_snapshot * toistettu) {
+    unsigned int i;
+    int sc;
+
+    snapshot = *toistettu;
+
+    for (i = 0; i < sizeof(live_keys) / sizeof(live_keys[0]); i++) {
+        sc = live_keys[i];
+        if (live_down[sc >> 5] & (1u << (sc & 31))) {
+            snapshot.down[sc >> 5] |= 1u << (sc & 31);
+            snapshot.last = sc;
         }
     }
+}
+
+/* The stream update_key_state() reads and writes now */
+static key_stream *active_key_stream(void) {
+    key_stream *peli = &key_streams[KEY_STREAM_GAME];
+
+    if (peli->kaytossa)
+        return peli;
 
-    return key ? key->keycode : SDLK_UNKNOWN;
+    return &key_streams[KEY_STREAM_MENU];
+}
+
+/* SDL timestamp of the latest joystick event */
+uint32_t joystick_event_time(void) {
+    return joystick_time;
+}
+
+/* Start recording the snapshots of stream virta (KEY_STREAM_*) to faili */
+void key_record_start(FILE * faili, int virta) {
+    key_streams[virta].kaytossa = 1;
+    key_streams[virta].record_file = faili;
+    key_streams[virta].frame = 0;
+}
+
+/* Start reading the snapshots of stream virta from faili */
+void key_playback_start(FILE * faili, int virta) {
+    memset(&key_streams[virta].toistettu, 0, sizeof(key_snapshot));
+    key_streams[virta].kaytossa = 1;
+    key_streams[virta].playback_file = faili;
+    key_streams[virta].tietue_luettu = 0;
+    key_streams[virta].frame = 0;
+}
+
+void key_record_stop(int virta) {
+    key_stream *s = &key_streams[virta];
+
+    s->kaytossa = 0;
+
+    if (s->record_file != NULL) {
+        fclose(s->record_file);
+        s->record_file = NULL;
+    }
+
+    if (s->playback_file != NULL) {
+        fclose(s->playback_file);
+        s->playback_file = NULL;
+    }
 }
 
 void update_key_state(void) {
-    static size_t event_number = 0;
+    static uint32_t event_number = 0;
+    key_stream *virta;
     SDL_Event ev;
-    Key *key = NULL;
+    int sc;
 
     while (SDL_PollEvent(&ev)) {
         switch (ev.type) {
@@ -223,50 +396,225 @@ void update_key_state(void) {
                 break;
             }
 
-            const SDL_Keycode pressed = ev.key.keysym.sym;
-            key = find_key(pressed);
-            if (key) {
-                key->keycode = pressed;
-                key->pressed = 1;
-                key->event_id = event_number++;
-            }
+            sc = ev.key.keysym.scancode;
+            if (sc <= 0 || sc >= SDL_NUM_SCANCODES)
+                break;
+
+            if (ev.key.keysym.sym >= 0 && ev.key.keysym.sym < 256)
+                keycode_scancode[ev.key.keysym.sym] = (SDL_Scancode) sc;
+
+            if (!(live_down[sc >> 5] & (1u << (sc & 31))) && !live_change_time)
+                live_change_time = ev.key.timestamp;
+
+            live_down[sc >> 5] |= 1u << (sc & 31);
+            live_event_id[sc] = ++event_number;
             break;
         }
-        case SDL_KEYUP: {
-            const SDL_Keycode pressed = ev.key.keysym.sym;
-            key = find_key(pressed);
-            if (key && key->keycode == pressed) {
-                memset(key, 0, sizeof(*key));
+        case SDL_KEYUP:
+            sc = ev.key.keysym.scancode;
+            if (sc > 0 && sc < SDL_NUM_SCANCODES) {
+                if ((live_down[sc >> 5] & (1u << (sc & 31))) && !live_change_time)
+                    live_change_time = ev.key.timestamp;
+
+                live_down[sc >> 5] &= ~(1u << (sc & 31));
             }
             break;
-        }
+        case SDL_JOYAXISMOTION:
+        case SDL_JOYHATMOTION:
+        case SDL_JOYBUTTONDOWN:
+        case SDL_JOYBUTTONUP:
+            joystick_time = ev.common.timestamp;
+            break;
         case SDL_QUIT:
             exit(0);
             break;
         }
     }
+
+    virta = active_key_stream();
+
+    if (virta->playback_file != NULL) {
+        read_key_record(virta);
+        merge_live_keys(&virta->toistettu);
+        input_latency_frame(0);
+    } else {
+        freeze_live_keys();
+        input_latency_frame(live_change_time);
+    }
+    live_change_time = 0;
+
+    if (virta->record_file != NULL)
+        write_key_record(virta);
+
+    virta->frame++;
 }
 
+int sdl_audio_rate = 0;
+int sdl_audio_buffer = 0;
+int sdl_audio_latency_log = 0;
+const char *sdl_audio_wav_file = NULL;
+
+/* Samples go to the offline WAV mixer instead of SDL_mixer */
+static int offline_audio = 0;
+
+#define SDL_SAMPLE_CHANNELS WAVMIX_CHANNELS
+
+#ifdef HAVE_SDL_MIXER
+#define SDL_AUDIO_MIN_BUFFER 256
+#define SDL_AUDIO_MAX_BUFFER 4096
+#define SDL_AUDIO_PROBE_MS 250
+#define SDL_LATENCY_LOG_SIZE 64
+
+static int probe_calls;
+static Uint64 probe_previous, probe_max_gap;
+
+/* channel_started and latency_log are shared with the audio thread */
+static SDL_mutex *latency_lukko = NULL;
+static Uint64 channel_started[SDL_SAMPLE_CHANNELS];
+static Uint64 latency_log[SDL_LATENCY_LOG_SIZE];
+static int latency_log_count;
+static Uint64 latency_sum, latency_max;
+static int latency_samples;
+
+static void probe_postmix(void *udata, Uint8 * stream, int len) {
+    Uint64 now = SDL_GetPerformanceCounter();
+
+    if (probe_calls++ > 1 && now - probe_previous > probe_max_gap)
+        probe_max_gap = now - probe_previous;
+    probe_previous = now;
+}
+
+/*
+ * Let the freshly opened device play silence for a moment and check
+ * that the mixer was called once per buffer. A buffer that is too
+ * small for the machine shows up as missed or late callbacks.
+ */
+static int audio_buffer_keeps_up(int rate, int buffer) {
+    Uint64 period = SDL_GetPerformanceFrequency() * buffer / rate;
+    int expected = SDL_AUDIO_PROBE_MS * rate / 1000 / buffer;
+
+    probe_calls = 0;
+    probe_max_gap = 0;
+
+    Mix_SetPostMix(probe_postmix, NULL);
+    SDL_Delay(SDL_AUDIO_PROBE_MS);
+    Mix_SetPostMix(NULL, NULL);
+
+    return probe_calls >= expected * 3 / 4 && probe_max_gap < 2 * period;
+}
+
+/* Time from sdl_play_sample() to the buffer its first samples went to */
+static void latency_postmix(void *udata, Uint8 * stream, int len) {
+    Uint64 now = SDL_GetPerformanceCounter();
+    int ch;
+
+    SDL_LockMutex(latency_lukko);
+
+    for (ch = 0; ch < SDL_SAMPLE_CHANNELS; ch++) {
+        if (!channel_started[ch])
+            continue;
+
+        if (latency_log_count < SDL_LATENCY_LOG_SIZE)
+            latency_log[latency_log_count++] = now - channel_started[ch];
+        channel_started[ch] = 0;
+    }
+
+    SDL_UnlockMutex(latency_lukko);
+}
+
+static void print_latency_log(void) {
+    Uint64 loki[SDL_LATENCY_LOG_SIZE];
+    double ms = 1000.0 / SDL_GetPerformanceFrequency();
+    double puskuri_ms = 1000.0 * sdl_audio_buffer / sdl_audio_rate;
+    int kpl, l;
+
+    SDL_LockMutex(latency_lukko);
+    kpl = latency_log_count;
+    memcpy(loki, latency_log, kpl * sizeof(Uint64));
+    latency_log_count = 0;
+    SDL_UnlockMutex(latency_lukko);
+
+    for (l = 0; l < kpl; l++) {
+        printf("Sample latency: mixed after %.1f ms, audible after %.1f ms\n", loki[l] * ms, loki[l] * ms + puskuri_ms);
+
+        latency_sum += loki[l];
+        if (loki[l] > latency_max)
+            latency_max = loki[l];
+        latency_samples++;
+    }
+}
+#endif
+
 /**
  * Initialize SDL sounds so that sdl_play_sample can be called.
+ * With sdl_audio_wav_file set, samples are rendered to that file
+ * instead.
+ * @param rate output sample rate in Hz.
+ * @param buffer mixer buffer in sample frames, 0 to pick the smallest
+ * one that plays without dropouts.
  * @return 0 on success, nonzero otherwise.
  */
-int sdl_init_sounds(void) {
+int sdl_init_sounds(int rate, int buffer) {
+    if (sdl_audio_wav_file != NULL) {
+        if (!wavmix_open(sdl_audio_wav_file))
+            return 1;
+
+        offline_audio = 1;
+        return 0;
+    }
 #ifdef HAVE_SDL_MIXER
     int ret;
+    int probe = 0;
 
     ret = SDL_InitSubSystem(SDL_INIT_AUDIO);
     if (ret != 0)
         return 1;
 
+    if (buffer == 0) {
+#ifdef __EMSCRIPTEN__
+        buffer = SDL_AUDIO_MAX_BUFFER;
+#else
+        buffer = SDL_AUDIO_MIN_BUFFER;
+        probe = 1;
+#endif
+    }
+
     /*
-     * use a 4096 byte buffer:
-     * 44100*2*2 bytes/sec / 4096 bytes = about 1/43 seconds
+     * The buffer is in sample frames. 4096 frames, the old fixed
+     * size, is about 93 ms at 44100 Hz, 512 frames about 12 ms.
      */
-    ret = Mix_OpenAudio(44100, MIX_DEFAULT_FORMAT, 2, 4096);
-    if (ret < 0)
-        return 1;
-    Mix_AllocateChannels(16);   /* max. 16 simultaneous samples */
+    for (;;) {
+        ret = Mix_OpenAudio(rate, MIX_DEFAULT_FORMAT, 2, buffer);
+        if (ret < 0)
+            return 1;
+
+        if (!probe || buffer >= SDL_AUDIO_MAX_BUFFER || audio_buffer_keeps_up(rate, buffer))
+            break;
+
+        Mix_CloseAudio();
+        buffer *= 2;
+    }
+
+    Mix_QuerySpec(&sdl_audio_rate, NULL, NULL);
+    sdl_audio_buffer = buffer;
+
+    if (probe && sdl_audio_latency_log)
+        printf("Audio buffer %d frames at %d Hz.\n", sdl_audio_buffer, sdl_audio_rate);
+
+    Mix_AllocateChannels(SDL_SAMPLE_CHANNELS);  /* max. 16 simultaneous samples */
+
+    if (sdl_audio_latency_log) {
+        memset(channel_started, 0, sizeof(channel_started));
+        latency_log_count = 0;
+
+        if (latency_lukko == NULL)
+            latency_lukko = SDL_CreateMutex();
+        if (latency_lukko == NULL)
+            sdl_audio_latency_log = 0;
+        else
+            Mix_SetPostMix(latency_postmix, NULL);
+    }
+
     return 0;
 #else
     printf("This version of triplane has been compiled without sound support.\n");
@@ -276,79 +624,336 @@ int sdl_init_sounds(void) {
 
 /** Deinitalize SDL sounds */
 void sdl_uninit_sounds(void) {
+    if (offline_audio) {
+        wavmix_close();
+        offline_audio = 0;
+        return;
+    }
 #ifdef HAVE_SDL_MIXER
+    if (sdl_audio_latency_log) {
+        Mix_SetPostMix(NULL, NULL);
+        print_latency_log();
+
+        if (latency_samples)
+            printf("Sample latency: %d samples, average %.1f ms, worst %.1f ms to mix\n", latency_samples,
+                   1000.0 * latency_sum / latency_samples / SDL_GetPerformanceFrequency(), 1000.0 * latency_max / SDL_GetPerformanceFrequency());
+    }
+
     Mix_CloseAudio();
     SDL_QuitSubSystem(SDL_INIT_AUDIO);
 #endif
 }
 
+/*
+ * Voice manager. Each mixer channel remembers the sample it plays and
+ * its rank, the sample priority first and the distance from the
+ * listener second. A sample started twice in one frame plays once, and
+ * when every channel is busy the lowest ranked voice, the oldest of
+ * equals, gives way to a request that ranks at least as high. Looping
+ * voices are never taken.
+ */
+#define SDL_VOICE_MAX_DISTANCE 4095
+
+struct sdl_voice {
+    sb_sample *sample;
+    int rank;
+    int looping;
+    unsigned int frame;
+};
+
+static sdl_voice voices[SDL_SAMPLE_CHANNELS];
+static unsigned int voice_frame = 1;
+
+static int voice_rank(sb_sample * sample, int distance) {
+    if (distance > SDL_VOICE_MAX_DISTANCE)
+        distance = SDL_VOICE_MAX_DISTANCE;
+
+    return sample->priority * (SDL_VOICE_MAX_DISTANCE + 1) + SDL_VOICE_MAX_DISTANCE - distance;
+}
+
+static int voice_playing(int ch) {
+    if (offline_audio)
+        return wavmix_playing(ch);
+#ifdef HAVE_SDL_MIXER
+    return Mix_Playing(ch);
+#else
+    return 0;
+#endif
+}
+
+static void voice_halt(int ch) {
+    if (offline_audio) {
+        wavmix_halt(ch);
+        return;
+    }
+#ifdef HAVE_SDL_MIXER
+    Mix_HaltChannel(ch);
+#endif
+}
+
+static void voice_panning(int ch, int l, int r) {
+    if (offline_audio) {
+        wavmix_panning(ch, l, r);
+        return;
+    }
+#ifdef HAVE_SDL_MIXER
+    Mix_SetPanning(ch, l, r);
+#endif
+}
+
+static int voice_start(int ch, sb_sample * sample, int looping) {
+    if (offline_audio) {
+        if (sample->pcm.data == NULL)
+            return -1;
+
+        wavmix_play(ch, &sample->pcm, looping);
+        return ch;
+    }
+#ifdef HAVE_SDL_MIXER
+    return Mix_PlayChannel(ch, sample->chunk, looping ? -1 : 0);
+#else
+    return -1;
+#endif
+}
+
+static int find_voice(int rank) {
+    int ch, uhri = -1;
+
+    for (ch = 0; ch < SDL_SAMPLE_CHANNELS; ch++)
+        if (!voice_playing(ch))
+            return ch;
+
+    for (ch = 0; ch < SDL_SAMPLE_CHANNELS; ch++) {
+        if (voices[ch].looping)
+            continue;
+
+        if (uhri == -1 || voices[ch].rank < voices[uhri].rank || (voices[ch].rank == voices[uhri].rank && voices[ch].frame < voices[uhri].frame))
+            uhri = ch;
+    }
+
+    if (uhri == -1 || voices[uhri].rank > rank)
+        return -1;
+
+    voice_halt(uhri);
+    return uhri;
+}
+
+/**
+ * Start a new sound frame, samples are merged within one. The offline
+ * mixer renders one frame of audio here.
+ */
+void sdl_sample_frame(void) {
+    if (offline_audio)
+        wavmix_frame();
+
+    voice_frame++;
+}
+
 /**
  * Play sample.
  * @param sample sample loaded with sdl_load_sample.
+ * @param distance distance of the sound from the listener in pixels.
  */
-void sdl_play_sample(sb_sample * sample, int looping) {
-#ifdef HAVE_SDL_MIXER
+void sdl_play_sample(sb_sample * sample, int looping, int distance) {
     /* scale of left_volume and right_volume is [0..32] */
     /* SDL_SetPanning wants [0..255] */
     int ch, l = sample->left_volume * 8, r = sample->right_volume * 8;
+    int rank = voice_rank(sample, distance);
+
     if (l > 0)
         l--;
     if (r > 0)
         r--;
-    ch = Mix_PlayChannel(-1, sample->chunk, looping ? -1 : 0);
-    if (ch == -1) {             /* no free channels (or possibly another error) */
-        return;                 /* ignore the error, so this sound won't be played */
+
+#ifdef HAVE_SDL_MIXER
+    if (sdl_audio_latency_log && !offline_audio)
+        print_latency_log();
+#endif
+
+    for (ch = 0; ch < SDL_SAMPLE_CHANNELS; ch++) {
+        if (voices[ch].sample == sample && voices[ch].frame == voice_frame && !looping && voice_playing(ch)) {
+            // The nearer of the merged requests decides the panning
+            if (rank > voices[ch].rank) {
+                voices[ch].rank = rank;
+                voice_panning(ch, l, r);
+            }
+            return;
+        }
     }
 
-    Mix_SetPanning(ch, l, r);
+#ifdef HAVE_SDL_MIXER
+    Uint64 alku = SDL_GetPerformanceCounter();
+#endif
+
+    ch = find_voice(looping ? INT_MAX : rank);
+    if (ch != -1)
+        ch = voice_start(ch, sample, looping);
+
+    if (ch != -1) {
+        voices[ch].sample = sample;
+        voices[ch].rank = rank;
+        voices[ch].looping = looping;
+        voices[ch].frame = voice_frame;
+
+#ifdef HAVE_SDL_MIXER
+        if (sdl_audio_latency_log && !offline_audio) {
+            SDL_LockMutex(latency_lukko);
+            channel_started[ch] = alku;
+            SDL_UnlockMutex(latency_lukko);
+        }
 #endif
+
+        voice_panning(ch, l, r);
+    }
 }
 
 /** Stop playing all samples started with sdl_play_sample */
 void sdl_stop_all_samples(void) {
+    if (offline_audio) {
+        wavmix_halt(-1);
+        return;
+    }
 #ifdef HAVE_SDL_MIXER
     Mix_HaltChannel(-1);
 #endif
 }
 
+#ifdef HAVE_SDL_MIXER
+/*
+ * Sample store. Samples loaded between sdl_sample_store_begin() and
+ * sdl_sample_store_end() are converted to the mixer output format in
+ * one pass, straight from the datafile into a single block, and their
+ * chunks point into that block. SDL_mixer then neither copies nor
+ * converts them again.
+ */
+#define SDL_STORE_MAX 64
+
+static sb_sample *store_samples[SDL_STORE_MAX];
+static const uint8_t *store_wav[SDL_STORE_MAX];
+static int store_wav_len[SDL_STORE_MAX];
+static int store_kpl = 0;
+static int store_open = 0;
+static uint8_t *store_data = NULL;
+
+static void load_chunk(sb_sample * sample, const uint8_t * p, int len) {
+    sample->chunk = Mix_LoadWAV_RW(SDL_RWFromConstMem(p, len), 1);
+    if (sample->chunk == NULL) {
+        fprintf(stderr, "sdl_sample_load: %s\n", Mix_GetError());
+        exit(1);
+    }
+}
+#endif
+
+void sdl_sample_store_begin(void) {
+#ifdef HAVE_SDL_MIXER
+    store_kpl = 0;
+    store_open = !offline_audio && store_data == NULL;
+#endif
+}
+
+void sdl_sample_store_end(void) {
+#ifdef HAVE_SDL_MIXER
+    SDL_AudioCVT cvt[SDL_STORE_MAX];
+    size_t kohta[SDL_STORE_MAX];
+    size_t koko = 0;
+    int freq, channels;
+    Uint16 format;
+    int l, ok;
+
+    if (!store_open)
+        return;
+    store_open = 0;
+
+    ok = Mix_QuerySpec(&freq, &format, &channels);
+
+    for (l = 0; l < store_kpl && ok; l++) {
+        const wavmix_sample *pcm = &store_samples[l]->pcm;
+
+        if (SDL_BuildAudioCVT(&cvt[l], pcm->bits == 8 ? AUDIO_U8 : AUDIO_S16LSB, 1, pcm->rate, format, channels, freq) < 0)
+            ok = 0;
+
+        cvt[l].len = pcm->frames * (pcm->bits / 8);
+        kohta[l] = koko;
+        koko += ((size_t) cvt[l].len * cvt[l].len_mult + 15) & ~(size_t) 15;
+    }
+
+    if (!ok) {
+        for (l = 0; l < store_kpl; l++)
+            load_chunk(store_samples[l], store_wav[l], store_wav_len[l]);
+        return;
+    }
+
+    store_data = (uint8_t *) walloc(koko ? koko : 1, WALLOC_SAMPLE);
+
+    for (l = 0; l < store_kpl; l++) {
+        cvt[l].buf = store_data + kohta[l];
+        memcpy(cvt[l].buf, store_samples[l]->pcm.data, cvt[l].len);
+
+        if (cvt[l].needed)
+            SDL_ConvertAudio(&cvt[l]);
+        else
+            cvt[l].len_cvt = cvt[l].len;
+
+        store_samples[l]->chunk = Mix_QuickLoad_RAW(cvt[l].buf, cvt[l].len_cvt);
+    }
+#endif
+}
+
+/** Free the sample store, after the samples in it have been freed. */
+void sdl_sample_store_free(void) {
+#ifdef HAVE_SDL_MIXER
+    if (store_data != NULL) {
+        wfree(store_data);
+        store_data = NULL;
+    }
+    store_kpl = 0;
+#endif
+}
+
 /**
  * Load sample with given name.
  * @param name audio name used inside fokker.dks
  * @return loaded sample or NULL on error.
  */
 sb_sample *sdl_sample_load(const char *name) {
-#ifdef HAVE_SDL_MIXER
-    int len, ret;
-    uint8_t *p;
+    int len;
+    const uint8_t *p;
     sb_sample *sample;
 
-    ret = dksopen(name);
-    if (ret != 1) {
+    p = dksentry(name, &len);
+    if (p == NULL) {
         return NULL;
     }
 
-    len = dkssize();
-    p = (uint8_t *) walloc(len);
+    sample = (sb_sample *) walloc(sizeof(sb_sample), WALLOC_SAMPLE);
 
-    ret = dksread(p, len);
-    assert(ret == 1);
+    sample->priority = SAMPLE_PRIORITY_NORMAL;
 
-    dksclose();
+    // The offline mixer plays the PCM data straight from the datafile
+    if (!wavmix_parse(p, len, &sample->pcm))
+        sample->pcm.data = NULL;
 
-    sample = (sb_sample *) walloc(sizeof(sb_sample));
-
-    sample->chunk = Mix_LoadWAV_RW(SDL_RWFromConstMem(p, len), 1);
-    if (sample->chunk == NULL) {
-        fprintf(stderr, "sdl_sample_load: %s\n", Mix_GetError());
-        exit(1);
+#ifdef HAVE_SDL_MIXER
+    sample->chunk = NULL;
+
+    if (!offline_audio) {
+        if (store_open && store_kpl < SDL_STORE_MAX && sample->pcm.data != NULL) {
+            store_samples[store_kpl] = sample;
+            store_wav[store_kpl] = p;
+            store_wav_len[store_kpl] = len;
+            store_kpl++;
+        } else {
+            load_chunk(sample, p, len);
+        }
     }
-
-    free(p);
-
-    return sample;
 #else
-    return NULL;
+    if (!offline_audio) {
+        wfree(sample);
+        return NULL;
+    }
 #endif
+
+    return sample;
 }
 
 /**
@@ -356,13 +961,36 @@ sb_sample *sdl_sample_load(const char *name) {
  * @param sample to be free'd.
  */
 void sdl_free_sample(sb_sample * sample) {
+    int ch;
+
+    // No channel may go on playing or naming the freed sample
+    for (ch = 0; ch < SDL_SAMPLE_CHANNELS; ch++) {
+        if (voices[ch].sample == sample) {
+            voice_halt(ch);
+            memset(&voices[ch], 0, sizeof(voices[ch]));
+        }
+    }
+    if (offline_audio)
+        wavmix_halt_sample(&sample->pcm);
+
 #ifdef HAVE_SDL_MIXER
-    Mix_FreeChunk(sample->chunk);
-    free(sample);
+    if (sample->chunk != NULL)
+        Mix_FreeChunk(sample->chunk);
 #endif
+    wfree(sample);
 }
 
 sb_mod_file *sdl_load_mod_file(const char *name) {
+    sb_mod_file *silent;
+
+    // Music is not rendered offline, a silent module stands in for it
+    if (offline_audio) {
+        silent = (sb_mod_file *) walloc(sizeof(sb_mod_file), WALLOC_SAMPLE);
+#ifdef HAVE_SDL_MIXER
+        silent->music = NULL;
+#endif
+        return silent;
+    }
 #ifdef HAVE_SDL_MIXER
 #ifdef __EMSCRIPTEN__
     // At the time of writing, Emscripten's SDL_Mixer (SDL2) does not support
@@ -372,7 +1000,7 @@ sb_mod_file *sdl_load_mod_file(const char *name) {
 
     snprintf(path_buffer, sizeof(path_buffer), "web_music/%s.ogg", name);
 
-    mod = (sb_mod_file *) walloc(sizeof(sb_mod_file));
+    mod = (sb_mod_file *) walloc(sizeof(sb_mod_file), WALLOC_SAMPLE);
     mod->music = Mix_LoadMUS(path_buffer);
 
     if (!mod->music) {
@@ -382,25 +1010,17 @@ sb_mod_file *sdl_load_mod_file(const char *name) {
 
     return mod;
 #else
-    int len, ret;
-    uint8_t *p;
+    int len;
+    const uint8_t *p;
     sb_mod_file *mod;
     SDL_RWops *rwops;
 
-    ret = dksopen(name);
-    if (ret != 1) {
+    p = dksentry(name, &len);
+    if (p == NULL) {
         return NULL;
     }
 
-    len = dkssize();
-    p = (uint8_t *) walloc(len);
-
-    ret = dksread(p, len);
-    assert(ret == 1);
-
-    dksclose();
-
-    mod = (sb_mod_file *) walloc(sizeof(sb_mod_file));
+    mod = (sb_mod_file *) walloc(sizeof(sb_mod_file), WALLOC_SAMPLE);
 
     rwops = SDL_RWFromConstMem(p, len);
     mod->music = Mix_LoadMUS_RW(rwops, 0);
@@ -410,8 +1030,6 @@ sb_mod_file *sdl_load_mod_file(const char *name) {
         exit(1);
     }
 
-    free(p);
-
     return mod;
 #endif
 #else
@@ -421,19 +1039,25 @@ sb_mod_file *sdl_load_mod_file(const char *name) {
 
 void sdl_free_mod_file(sb_mod_file * mod) {
 #ifdef HAVE_SDL_MIXER
-    Mix_FreeMusic(mod->music);
-    free(mod);
+    if (mod->music != NULL)
+        Mix_FreeMusic(mod->music);
 #endif
+    wfree(mod);
 }
 
 void sdl_play_music(sb_mod_file * mod) {
-#ifdef HAVE_SDL_MIXER
     sdl_stop_all_samples();
+
+    if (offline_audio)
+        return;
+#ifdef HAVE_SDL_MIXER
     Mix_PlayMusic(mod->music, 1);
 #endif
 }
 
 void sdl_stop_music(void) {
+    if (offline_audio)
+        return;
 #ifdef HAVE_SDL_MIXER
     Mix_HaltMusic();
 #endif
@@ -21,13 +21,20 @@
 #ifndef SDL_COMPAT_H
 #define SDL_COMPAT_H
 #include <stdint.h>
+#include <stdio.h>
 #ifdef HAVE_SDL_MIXER
 #include <SDL_mixer.h>
 #endif
 #include "SDL_keycode.h"
+#include "io/wavmix.h"
 
 #define SAMPLE_VOLUME 20
 
+/* Voice priorities, higher ones may take the channel of lower ones */
+#define SAMPLE_PRIORITY_LOW    0
+#define SAMPLE_PRIORITY_NORMAL 1
+#define SAMPLE_PRIORITY_HIGH   2
+
 #define PAUSE_KEY SDLK_PAUSE
 
 #define SOUNDCARD_NONE 0
@@ -42,6 +49,8 @@ int getch(void);
 
 typedef struct {
     int right_volume, left_volume;
+    int priority;
+    wavmix_sample pcm;
 #ifdef HAVE_SDL_MIXER
     Mix_Chunk *chunk;
 #endif
@@ -57,18 +66,33 @@ bool is_key(SDL_Keycode key);
 bool is_any_key(void);
 SDL_Keycode last_key(void);
 void update_key_state(void);
-int sdl_init_sounds(void);
+uint32_t joystick_event_time(void);
+#define KEY_STREAM_MENU 0
+#define KEY_STREAM_GAME 1
+void key_record_start(FILE * faili, int virta);
+void key_playback_start(FILE * faili, int virta);
+void key_record_stop(int virta);
+int sdl_init_sounds(int rate, int buffer);
 void sdl_uninit_sounds(void);
-void sdl_play_sample(sb_sample * sample, int looping = 0);
+void sdl_play_sample(sb_sample * sample, int looping = 0, int distance = 0);
+void sdl_sample_frame(void);
 void sdl_stop_all_samples(void);
 sb_sample *sdl_sample_load(const char *name);
 void sdl_free_sample(sb_sample * sample);
+void sdl_sample_store_begin(void);
+void sdl_sample_store_end(void);
+void sdl_sample_store_free(void);
 
 sb_mod_file *sdl_load_mod_file(const char *name);
 void sdl_free_mod_file(sb_mod_file * mod);
 void sdl_play_music(sb_mod_file * mod);
 void sdl_stop_music(void);
 
+extern int sdl_audio_rate;
+extern int sdl_audio_buffer;
+extern int sdl_audio_latency_log;
+extern const char *sdl_audio_wav_file;
+
 void fs_init();
 void fs_deinit();
 void fs_flush();
@@ -26,6 +26,8 @@
 int is_there_sound = 1;
 int reverbed_channels = 0;
 int soundcard_type = SOUNDCARD_NONE;
+int sound_rate = 0;
+int sound_buffer = -1;
 
 int play_sample(sb_sample * sample_ptr) {
     if (is_there_sound) {
@@ -72,22 +74,35 @@ int play_2d_sample(sb_sample * sample_ptr, int player, int target) {
 
 
         }
-        sdl_play_sample(sample_ptr);
+        sdl_play_sample(sample_ptr, 0, abs(target - player));
     }
 
     return 0;
 }
 
 void init_sounds(void) {
+    int rate = sound_rate ? sound_rate : config.audio_rate;
+    int buffer = sound_buffer >= 0 ? sound_buffer : config.audio_buffer;
+
     soundcard_type = SOUNDCARD_NONE;
 
-    if (sdl_init_sounds() != 0) {
+    if (rate < 8000 || rate > 96000)
+        rate = 44100;
+
+    if (buffer != 0 && (buffer < 64 || buffer > 16384))
+        buffer = 0;
+
+    if (sdl_init_sounds(rate, buffer) != 0) {
         is_there_sound = 0;
         printf("SDL sound init failed. Switching sounds off.\n");
 
     } else {
         is_there_sound = 1;
         soundcard_type = SOUNDCARD_SDL;
+
+        // Keep the probed size so that the next start need not probe
+        if (buffer == 0 && sound_buffer < 0 && sdl_audio_buffer)
+            config.audio_buffer = sdl_audio_buffer;
     }
 
     return;
@@ -33,5 +33,7 @@ sb_sample *sample_load(const char *sample_name);
 extern int is_there_sound;
 extern int soundcard_type;
 extern int reverbed_channels;
+extern int sound_rate;
+extern int sound_buffer;
 
 #endif
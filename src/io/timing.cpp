@@ -20,34 +20,246 @@
 
 #include <SDL.h>
 #include <assert.h>
+#include <stdio.h>
 #include "sdl_compat.h"
+#include "io/timing.h"
 
 static int enabled = 1;
 
+/*
+ * Frame deadlines are kept in performance counter ticks. The period
+ * freq / fps is added whole and its remainder carried in
+ * deadline_jaannos, so the long-run rate is exact. Waiting sleeps with
+ * SDL_Delay() until sleep_marginal before the deadline and spins the
+ * rest. The margin follows how late SDL_Delay() has actually woken up.
+ */
+#define SLEEP_MARGINAL_MAX 20
+
+#define MAX_CATCHUP_FRAMES 4
+
+static Uint64 deadline = 0;
+static Uint64 kehys_pituus = 0;
+static Uint64 deadline_jaannos = 0;
+static Uint64 sleep_marginal = 0;
+static Uint64 edellinen_kehys = 0;
+
+/* Frame time histogram in 0.1 ms steps, the last bucket collects the rest */
+#define FRAME_HISTOGRAM_SIZE 1000
+
+static uint32_t frame_histogram[FRAME_HISTOGRAM_SIZE];
+static uint32_t frame_count = 0;
+static Uint64 frame_max = 0;
+
+static void record_frame(Uint64 nyt, Uint64 freq) {
+    Uint64 kesto, lokero;
+
+    if (edellinen_kehys) {
+        kesto = nyt - edellinen_kehys;
+        lokero = kesto * 10000 / freq;
+        if (lokero >= FRAME_HISTOGRAM_SIZE)
+            lokero = FRAME_HISTOGRAM_SIZE - 1;
+
+        frame_histogram[lokero]++;
+        frame_count++;
+        if (kesto > frame_max)
+            frame_max = kesto;
+    }
+
+    edellinen_kehys = nyt;
+}
+
 void nopeuskontrolli(int fps) {
-    static uint32_t viimeinen_aika = 0;
-    uint32_t target_tick;
+    Uint64 freq = SDL_GetPerformanceFrequency();
+    Uint64 nyt = SDL_GetPerformanceCounter();
+    Uint64 ms = freq / 1000;
+    Uint64 herays;
+    Uint32 viive;
 
     if (!enabled) {
         return;
     }
 
-    target_tick = viimeinen_aika + 1000 / fps;
-    while (SDL_GetTicks() <= target_tick) {
-        uint32_t diff = target_tick - SDL_GetTicks();
-        if (diff > 10 && diff < 1000) {
-            SDL_Delay(diff);
-        }
+    if (deadline == 0) {
+        deadline = nyt;
+        deadline_jaannos = 0;
+        sleep_marginal = 2 * ms;
+    }
+
+    kehys_pituus = freq / fps;
+    deadline += freq / fps;
+    deadline_jaannos += freq % fps;
+    if (deadline_jaannos >= (Uint64) fps) {
+        deadline++;
+        deadline_jaannos -= fps;
     }
 
-    viimeinen_aika += 1000 / fps;
+    while (nyt + sleep_marginal < deadline) {
+        viive = (Uint32) ((deadline - nyt - sleep_marginal) / ms);
+        if (viive == 0)
+            break;
+
+        herays = nyt + viive * ms;
+        SDL_Delay(viive);
+        nyt = SDL_GetPerformanceCounter();
 
-    // Recover from stopped process
-    if (SDL_GetTicks() > viimeinen_aika + 1000 / fps) {
-        viimeinen_aika = SDL_GetTicks();
+        // Widen the margin at once if we overslept, narrow it slowly
+        if (nyt > herays + sleep_marginal)
+            sleep_marginal = nyt - herays < SLEEP_MARGINAL_MAX * ms ? nyt - herays : SLEEP_MARGINAL_MAX * ms;
+        else if (sleep_marginal > ms)
+            sleep_marginal -= sleep_marginal / 16;
     }
+
+    while (nyt < deadline)
+        nyt = SDL_GetPerformanceCounter();
+
+    // Late frames are caught up by not waiting, up to a point. Beyond
+    // that, as after a stopped process, start over from now.
+    if (nyt > deadline + MAX_CATCHUP_FRAMES * (freq / fps)) {
+        deadline = nyt;
+        deadline_jaannos = 0;
+    }
+
+    record_frame(nyt, freq);
+}
+
+/* Is the next frame already due, so that it should be run at once? */
+int nopeuskontrolli_behind(void) {
+    if (!enabled || deadline == 0)
+        return 0;
+
+    return SDL_GetPerformanceCounter() > deadline + kehys_pituus;
+}
+
+/* Number of buckets below which osuus per mille of the samples fall */
+static int histogram_percentile(const uint32_t * histogram, int koko, uint32_t count, int osuus) {
+    uint32_t raja = (uint32_t) ((uint64_t) count * osuus / 1000);
+    uint32_t summa = 0;
+    int l;
+
+    for (l = 0; l < koko; l++) {
+        summa += histogram[l];
+        if (summa > raja)
+            return l + 1;
+    }
+
+    return koko;
+}
+
+void nopeuskontrolli_stats(frame_stats * stats) {
+    stats->frames = frame_count;
+    stats->p50 = histogram_percentile(frame_histogram, FRAME_HISTOGRAM_SIZE, frame_count, 500) / 10.0;
+    stats->p99 = histogram_percentile(frame_histogram, FRAME_HISTOGRAM_SIZE, frame_count, 990) / 10.0;
+    stats->max = frame_count ? 1000.0 * frame_max / SDL_GetPerformanceFrequency() : 0;
+
+    // The buckets round up, the exact maximum is known
+    if (stats->p50 > stats->max)
+        stats->p50 = stats->max;
+    if (stats->p99 > stats->max)
+        stats->p99 = stats->max;
+}
+
+void nopeuskontrolli_report(void) {
+    frame_stats stats;
+
+    nopeuskontrolli_stats(&stats);
+    printf("Frame times: %u frames, p50 %.1f ms, p99 %.1f ms, max %.1f ms\n", stats.frames, stats.p50, stats.p99, stats.max);
 }
 
 void nopeuskontrolli_enable(int enable) {
     enabled = enable;
 }
+
+/*
+ * Input latency, from the SDL timestamp of an input event to the
+ * present of the first frame simulated with it. The input of a frame
+ * is read into new_mc_* by controls(), copied to mc_* by the next
+ * controls() and simulated and drawn in the frame after that, so a
+ * time waits in odottava, keratty and sovellettu in turn. Times are
+ * SDL_GetTicks() milliseconds, 0 meaning none.
+ */
+#define LATENCY_HISTOGRAM_SIZE 1000
+
+static uint32_t latency_odottava = 0;
+static uint32_t latency_keratty = 0;
+static uint32_t latency_sovellettu = 0;
+static uint32_t latency_viimeisin = 0;
+
+static uint32_t latency_histogram[LATENCY_HISTOGRAM_SIZE];
+static uint32_t latency_count = 0;
+static uint32_t latency_max = 0;
+
+static uint32_t earlier_time(uint32_t a, uint32_t b) {
+    if (!a)
+        return b;
+    if (!b)
+        return a;
+
+    return (int32_t) (a - b) < 0 ? a : b;
+}
+
+/* Input of the current frame, replaces what was there */
+void input_latency_frame(uint32_t aika) {
+    latency_odottava = aika;
+}
+
+/* More input of the current frame, the earliest time is kept */
+void input_latency_event(uint32_t aika) {
+    latency_odottava = earlier_time(latency_odottava, aika);
+}
+
+/* Called by controls() once per frame after reading the controls */
+void input_latency_apply(void) {
+    latency_sovellettu = earlier_time(latency_sovellettu, latency_keratty);
+    latency_keratty = latency_odottava;
+    latency_odottava = 0;
+}
+
+void input_latency_reset(void) {
+    latency_odottava = latency_keratty = latency_sovellettu = 0;
+}
+
+/* Input time the frame being presented now answers to */
+uint32_t input_latency_take(void) {
+    uint32_t aika = latency_sovellettu;
+
+    latency_sovellettu = 0;
+    return aika;
+}
+
+void input_latency_presented(uint32_t aika) {
+    uint32_t kesto;
+
+    if (!aika)
+        return;
+
+    kesto = SDL_GetTicks() - aika;
+    latency_viimeisin = kesto;
+
+    latency_histogram[kesto < LATENCY_HISTOGRAM_SIZE ? kesto : LATENCY_HISTOGRAM_SIZE - 1]++;
+    latency_count++;
+    if (kesto > latency_max)
+        latency_max = kesto;
+}
+
+void input_latency_stats(frame_stats * stats) {
+    stats->frames = latency_count;
+    stats->p50 = histogram_percentile(latency_histogram, LATENCY_HISTOGRAM_SIZE, latency_count, 500);
+    stats->p99 = histogram_percentile(latency_histogram, LATENCY_HISTOGRAM_SIZE, latency_count, 990);
+    stats->max = latency_max;
+
+    if (stats->p50 > stats->max)
+        stats->p50 = stats->max;
+    if (stats->p99 > stats->max)
+        stats->p99 = stats->max;
+}
+
+unsigned int input_latency_last(void) {
+    return latency_viimeisin;
+}
+
+void input_latency_report(void) {
+    frame_stats stats;
+
+    input_latency_stats(&stats);
+    printf("Input latency: %u inputs, p50 %.0f ms, p99 %.0f ms, max %.0f ms\n", stats.frames, stats.p50, stats.p99, stats.max);
+}
@@ -20,8 +20,27 @@
 
 #ifndef TIMING_H
 #define TIMING_H
+#include <stdint.h>
+
+struct frame_stats {
+    unsigned int frames;
+    double p50, p99, max;       // milliseconds
+};
 
 void nopeuskontrolli(int fps = 24);
 void nopeuskontrolli_enable(int enable);
+int nopeuskontrolli_behind(void);
+void nopeuskontrolli_stats(frame_stats * stats);
+void nopeuskontrolli_report(void);
+
+void input_latency_frame(uint32_t aika);
+void input_latency_event(uint32_t aika);
+void input_latency_apply(void);
+void input_latency_reset(void);
+uint32_t input_latency_take(void);
+void input_latency_presented(uint32_t aika);
+void input_latency_stats(frame_stats * stats);
+unsigned int input_latency_last(void);
+void input_latency_report(void);
 
 #endif
@@ -21,6 +21,7 @@
 #include "io/video.h"
 #include "io/dksfile.h"
 #include "util/wutil.h"
+#include "io/timing.h"
 #include <SDL.h>
 #include <signal.h>
 #if !defined(_MSC_VER)
@@ -37,10 +38,48 @@ int current_mode = VGA_MODE;
 unsigned char *vircr;
 unsigned int window_multiplier_vga = 2, window_multiplier_svga = 1;
 int wantfullscreen = 0;
+int wantvsync = 1;
+int skip_presents = 0;
 SDL_Rect render_dest_rect;
 
 SDL_Color curpal[256];
 
+/*
+ * Overlapped presentation, used by main_engine(). While it is on,
+ * do_all() hands a copy of vircr and its palette to the present thread
+ * and returns at once. The thread converts the frame to RGBA while the
+ * main thread waits for the next frame and simulates and draws it. SDL
+ * wants the renderer used from the main thread only, so the converted
+ * frame is uploaded and shown by present_flush() at the start of the
+ * next do_all(). A frame therefore reaches the screen at most one frame
+ * late, also when schedule_present() skips the frames after it. Callers
+ * that stop calling do_all() for a while (pause) flush first so the
+ * last frame is not held back.
+ */
+static int pipeline_paalla = 0;
+static int pipeline_kesken = 0;
+static SDL_Thread *esitys_saie = NULL;
+static SDL_sem *esitys_tyo = NULL;
+static SDL_sem *esitys_valmis = NULL;
+static SDL_Surface *esitys_kopio = NULL;
+static uint8_t *esitys_rgba = NULL;
+static uint32_t esitys_syote = 0;
+
+/*
+ * Vsync is used only while present_pipeline() is on, that is during
+ * main_engine(). The fades and menus call do_all() in loops of their
+ * own and must not be slowed down to the display rate. Switching needs
+ * SDL 2.0.18; with older versions the game runs without vsync.
+ */
+static int vsync_paalla = 0;
+
+static void apply_vsync(void) {
+#if SDL_VERSION_ATLEAST(2, 0, 18)
+    if (video_state.renderer != NULL)
+        SDL_RenderSetVSync(video_state.renderer, vsync_paalla && wantvsync);
+#endif
+}
+
 /**
  * Sets palette entries firstcolor to firstcolor+n-1
  * from pal[0] to pal[n-1].
@@ -163,14 +202,9 @@ void decrease_scaling(void) {
     }
 }
 
-void do_all(int do_retrace) {
+static void convert_frame(SDL_Surface * lahde, void *pixels, int pitch) {
     /* Blit 8-bit surface to 32-bit surface */
-    SDL_BlitSurface(video_state.surface, NULL, video_state.displaySurface, NULL);
-
-    void *pixels;
-    int pitch;
-
-    SDL_LockTexture(video_state.texture, NULL, &pixels, &pitch);
+    SDL_BlitSurface(lahde, NULL, video_state.displaySurface, NULL);
 
     /* Convert 8-bit data to renderable 32-bit data */
     SDL_ConvertPixels(video_state.displaySurface->w, video_state.displaySurface->h,
@@ -178,14 +212,115 @@ void do_all(int do_retrace) {
         video_state.displaySurface->pixels, video_state.displaySurface->pitch,
         SDL_PIXELFORMAT_RGBA8888,
         pixels, pitch);
+}
 
-    SDL_UnlockTexture(video_state.texture);
-
+static void show_frame(void) {
     /* Render texture to display */
     SDL_RenderCopy(video_state.renderer, video_state.texture, NULL, &render_dest_rect);
     SDL_RenderPresent(video_state.renderer);
 }
 
+static int present_thread(void *dummy) {
+    for (;;) {
+        SDL_SemWait(esitys_tyo);
+        convert_frame(esitys_kopio, esitys_rgba, esitys_kopio->w * 4);
+        SDL_SemPost(esitys_valmis);
+    }
+
+    return 0;
+}
+
+/* Show the frame handed to the present thread, if any */
+void present_flush(void) {
+    if (!pipeline_kesken)
+        return;
+
+    SDL_SemWait(esitys_valmis);
+    pipeline_kesken = 0;
+
+    SDL_UpdateTexture(video_state.texture, NULL, esitys_rgba, esitys_kopio->w * 4);
+    show_frame();
+    input_latency_presented(esitys_syote);
+}
+
+void present_pipeline(int enable) {
+    vsync_paalla = enable;
+    apply_vsync();
+
+    if (!enable) {
+        present_flush();
+        pipeline_paalla = 0;
+        return;
+    }
+
+    if (esitys_saie == NULL) {
+        esitys_tyo = SDL_CreateSemaphore(0);
+        esitys_valmis = SDL_CreateSemaphore(0);
+        if (esitys_tyo == NULL || esitys_valmis == NULL)
+            return;
+
+        esitys_saie = SDL_CreateThread(present_thread, "present", NULL);
+        if (esitys_saie == NULL)
+            return;
+    }
+
+    pipeline_paalla = 1;
+}
+
+static void free_present_buffers(void) {
+    present_flush();
+
+    if (esitys_kopio != NULL) {
+        SDL_FreeSurface(esitys_kopio);
+        esitys_kopio = NULL;
+    }
+    if (esitys_rgba != NULL) {
+        wfree(esitys_rgba);
+        esitys_rgba = NULL;
+    }
+}
+
+static void hand_over_frame(void) {
+    SDL_Surface *s = video_state.surface;
+
+    present_flush();
+
+    if (esitys_kopio == NULL) {
+        esitys_kopio = SDL_CreateRGBSurface(0, s->w, s->h, 8, 0, 0, 0, 0);
+        assert(esitys_kopio);
+        esitys_rgba = (uint8_t *) walloc(s->w * s->h * 4);
+    }
+
+    SDL_SetPaletteColors(esitys_kopio->format->palette, s->format->palette->colors, 0, 256);
+    memcpy(esitys_kopio->pixels, s->pixels, s->pitch * s->h);
+
+    esitys_syote = input_latency_take();
+    pipeline_kesken = 1;
+    SDL_SemPost(esitys_tyo);
+}
+
+void do_all(int do_retrace) {
+    if (skip_presents) {
+        present_flush();
+        return;
+    }
+
+    if (pipeline_paalla) {
+        hand_over_frame();
+        return;
+    }
+
+    void *pixels;
+    int pitch;
+
+    SDL_LockTexture(video_state.texture, NULL, &pixels, &pitch);
+    convert_frame(video_state.surface, pixels, pitch);
+    SDL_UnlockTexture(video_state.texture);
+
+    show_frame();
+    input_latency_presented(input_latency_take());
+}
+
 static void sigint_handler(int dummy) {
     _exit(1);
 }
@@ -208,6 +343,8 @@ void init_video(void) {
 }
 
 static void deinit() {
+    free_present_buffers();
+
     if (video_state.texture) {
         SDL_DestroyTexture(video_state.texture);
         video_state.texture = NULL;
@@ -273,6 +410,7 @@ static int init_mode(int new_mode, const char *paletname) {
     assert(video_state.surface);
 
     video_state.renderer = SDL_CreateRenderer(video_state.window, -1, 0);
+    apply_vsync();
 
     assert(video_state.surface);
 
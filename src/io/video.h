@@ -50,6 +50,8 @@ void setpal(int vari, char R, char G, char B);
 void setpal_range(const char pal[][3], int firstcolor, int n, int reverse = 0);
 void fillrect(int x, int y, int w, int h, int c);
 void do_all(int do_retrace = 0);
+void present_pipeline(int enable);
+void present_flush(void);
 int init_vesa(const char *paletname);
 void init_vga(const char *paletname);
 void init_video(void);
@@ -66,5 +68,7 @@ extern Bitmap *standard_background;
 extern int current_mode;
 extern unsigned int window_multiplier_vga, window_multiplier_svga;
 extern int wantfullscreen;
+extern int wantvsync;
+extern int skip_presents;
 
 #endif
@@ -0,0 +1,252 @@
+/* 
+ * Triplane Classic - a side-scrolling dogfighting game.
+ * Copyright (C) 1996,1997,2009  Dodekaedron Software Creations Oy
+ * 
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * tjt@users.sourceforge.net
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "io/wavmix.h"
+
+#define WAVMIX_HEADER 44
+#define WAVMIX_MAX_FRAMES (WAVMIX_RATE / WAVMIX_FPS + 1)
+
+struct wavmix_voice {
+    const wavmix_sample *sample;
+    uint32_t kohta;             // 16.16 position in sample frames
+    uint32_t askel;
+    int looping;
+    int left, right;
+};
+
+static FILE *wav_faili = NULL;
+static uint32_t wav_data_koko;
+static int wav_jaannos;
+static wavmix_voice voices[WAVMIX_CHANNELS];
+
+static uint32_t get_le32(const uint8_t * p) {
+    return p[0] | (p[1] << 8) | (p[2] << 16) | ((uint32_t) p[3] << 24);
+}
+
+static int get_le16(const uint8_t * p) {
+    return p[0] | (p[1] << 8);
+}
+
+static void put_le32(uint8_t * p, uint32_t arvo) {
+    p[0] = arvo;
+    p[1] = arvo >> 8;
+    p[2] = arvo >> 16;
+    p[3] = arvo >> 24;
+}
+
+static void put_le16(uint8_t * p, int arvo) {
+    p[0] = arvo;
+    p[1] = arvo >> 8;
+}
+
+/*
+ * Find the PCM data of a RIFF WAVE file. Only uncompressed mono 8 and
+ * 16-bit files are accepted, which is what the datafile has.
+ */
+int wavmix_parse(const uint8_t * wav, int len, wavmix_sample * sample) {
+    int kohta = 12;
+    int fmt = 0;
+    uint32_t koko;
+
+    if (len < 12 || memcmp(wav, "RIFF", 4) || memcmp(wav + 8, "WAVE", 4))
+        return 0;
+
+    while (kohta + 8 <= len) {
+        koko = get_le32(wav + kohta + 4);
+
+        if (koko > (uint32_t) (len - kohta - 8))
+            koko = len - kohta - 8;
+
+        if (!memcmp(wav + kohta, "fmt ", 4) && koko >= 16) {
+            if (get_le16(wav + kohta + 8) != 1 || get_le16(wav + kohta + 10) != 1)
+                return 0;
+
+            sample->rate = get_le32(wav + kohta + 12);
+            sample->bits = get_le16(wav + kohta + 22);
+            if ((sample->bits != 8 && sample->bits != 16) || sample->rate == 0)
+                return 0;
+            fmt = 1;
+        } else if (!memcmp(wav + kohta, "data", 4) && fmt) {
+            sample->data = wav + kohta + 8;
+            sample->frames = koko / (sample->bits / 8);
+            return 1;
+        }
+
+        kohta += 8 + koko + (koko & 1);
+    }
+
+    return 0;
+}
+
+int wavmix_open(const char *filename) {
+    uint8_t otsikko[WAVMIX_HEADER];
+
+    wav_faili = fopen(filename, "wb");
+    if (wav_faili == NULL) {
+        printf("Unable to create %s\n", filename);
+        return 0;
+    }
+
+    memset(otsikko, 0, sizeof(otsikko));
+    if (fwrite(otsikko, sizeof(otsikko), 1, wav_faili) != 1) {
+        fclose(wav_faili);
+        wav_faili = NULL;
+        return 0;
+    }
+
+    memset(voices, 0, sizeof(voices));
+    wav_data_koko = 0;
+    wav_jaannos = 0;
+
+    // Leave a valid file behind also when the game quits with exit()
+    atexit(wavmix_close);
+    return 1;
+}
+
+void wavmix_close(void) {
+    uint8_t otsikko[WAVMIX_HEADER];
+
+    if (wav_faili == NULL)
+        return;
+
+    memcpy(otsikko, "RIFF", 4);
+    put_le32(otsikko + 4, 36 + wav_data_koko);
+    memcpy(otsikko + 8, "WAVEfmt ", 8);
+    put_le32(otsikko + 16, 16);
+    put_le16(otsikko + 20, 1);
+    put_le16(otsikko + 22, 2);
+    put_le32(otsikko + 24, WAVMIX_RATE);
+    put_le32(otsikko + 28, WAVMIX_RATE * 4);
+    put_le16(otsikko + 32, 4);
+    put_le16(otsikko + 34, 16);
+    memcpy(otsikko + 36, "data", 4);
+    put_le32(otsikko + 40, wav_data_koko);
+
+    fseek(wav_faili, 0, SEEK_SET);
+    fwrite(otsikko, sizeof(otsikko), 1, wav_faili);
+    fclose(wav_faili);
+    wav_faili = NULL;
+}
+
+int wavmix_playing(int channel) {
+    return voices[channel].sample != NULL;
+}
+
+void wavmix_play(int channel, const wavmix_sample * sample, int looping) {
+    voices[channel].sample = sample;
+    voices[channel].kohta = 0;
+    voices[channel].askel = (uint32_t) (((uint64_t) sample->rate << 16) / WAVMIX_RATE);
+    voices[channel].looping = looping;
+    voices[channel].left = 255;
+    voices[channel].right = 255;
+}
+
+void wavmix_panning(int channel, int left, int right) {
+    voices[channel].left = left;
+    voices[channel].right = right;
+}
+
+void wavmix_halt(int channel) {
+    int l;
+
+    if (channel >= 0) {
+        voices[channel].sample = NULL;
+        return;
+    }
+
+    for (l = 0; l < WAVMIX_CHANNELS; l++)
+        voices[l].sample = NULL;
+}
+
+/* Stop every channel playing sample, before it is freed */
+void wavmix_halt_sample(const wavmix_sample * sample) {
+    int l;
+
+    for (l = 0; l < WAVMIX_CHANNELS; l++)
+        if (voices[l].sample == sample)
+            voices[l].sample = NULL;
+}
+
+static int voice_value(wavmix_voice * voice) {
+    const wavmix_sample *sample = voice->sample;
+    int kohta = voice->kohta >> 16;
+
+    if (sample->bits == 8)
+        return (sample->data[kohta] - 128) * 256;
+
+    return (int16_t) get_le16(sample->data + kohta * 2);
+}
+
+/* Mix and write one game frame worth of audio. */
+void wavmix_frame(void) {
+    int32_t vasen[WAVMIX_MAX_FRAMES], oikea[WAVMIX_MAX_FRAMES];
+    uint8_t ulos[WAVMIX_MAX_FRAMES * 4];
+    int kpl, l, ch, arvo;
+    wavmix_voice *voice;
+
+    if (wav_faili == NULL)
+        return;
+
+    wav_jaannos += WAVMIX_RATE;
+    kpl = wav_jaannos / WAVMIX_FPS;
+    wav_jaannos %= WAVMIX_FPS;
+
+    memset(vasen, 0, kpl * sizeof(int32_t));
+    memset(oikea, 0, kpl * sizeof(int32_t));
+
+    for (ch = 0; ch < WAVMIX_CHANNELS; ch++) {
+        voice = &voices[ch];
+
+        for (l = 0; l < kpl && voice->sample != NULL; l++) {
+            if ((int) (voice->kohta >> 16) >= voice->sample->frames) {
+                if (!voice->looping || voice->sample->frames == 0) {
+                    voice->sample = NULL;
+                    break;
+                }
+                voice->kohta -= (uint32_t) voice->sample->frames << 16;
+            }
+
+            arvo = voice_value(voice);
+            vasen[l] += arvo * voice->left / 255;
+            oikea[l] += arvo * voice->right / 255;
+            voice->kohta += voice->askel;
+        }
+    }
+
+    for (l = 0; l < kpl; l++) {
+        if (vasen[l] > 32767)
+            vasen[l] = 32767;
+        if (vasen[l] < -32768)
+            vasen[l] = -32768;
+        if (oikea[l] > 32767)
+            oikea[l] = 32767;
+        if (oikea[l] < -32768)
+            oikea[l] = -32768;
+
+        put_le16(ulos + l * 4, vasen[l]);
+        put_le16(ulos + l * 4 + 2, oikea[l]);
+    }
+
+    if (fwrite(ulos, kpl * 4, 1, wav_faili) == 1)
+        wav_data_koko += kpl * 4;
+}
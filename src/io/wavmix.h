@@ -0,0 +1,54 @@
+/* 
+ * Triplane Classic - a side-scrolling dogfighting game.
+ * Copyright (C) 1996,1997,2009  Dodekaedron Software Creations Oy
+ * 
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * tjt@users.sourceforge.net
+ */
+
+#ifndef WAVMIX_H
+#define WAVMIX_H
+#include <stdint.h>
+
+/*
+ * Offline software mixer. Samples are mixed into a 16-bit stereo WAV
+ * file, one game frame at a time, so the same replay always renders
+ * the same audio regardless of the speed it is run at.
+ */
+
+#define WAVMIX_RATE 22050
+#define WAVMIX_FPS 24
+#define WAVMIX_CHANNELS 16
+
+typedef struct {
+    const uint8_t *data;
+    int frames;
+    int rate;
+    int bits;
+} wavmix_sample;
+
+int wavmix_parse(const uint8_t * wav, int len, wavmix_sample * sample);
+
+int wavmix_open(const char *filename);
+void wavmix_close(void);
+
+int wavmix_playing(int channel);
+void wavmix_play(int channel, const wavmix_sample * sample, int looping);
+void wavmix_panning(int channel, int left, int right);
+void wavmix_halt(int channel);
+void wavmix_halt_sample(const wavmix_sample * sample);
+void wavmix_frame(void);
+
+#endif
@@ -594,8 +594,8 @@ int solo_player_menu(void) {
 
     int highest_mission = 0;
 
-    if (findparameter("-solomenumission")) {
-        sscanf(parametrit[findparameter("-solomenumission") + 1], "%d", &mission_re_fly);
+    if (options.solomenumission != -1) {
+        mission_re_fly = options.solomenumission;
     }
 
     if (mission_re_fly == 999) {
@@ -611,6 +611,7 @@ int solo_player_menu(void) {
 
     if (mission_re_fly != -1) {
         solo_mission = mission_re_fly;
+        prefetch_next_level(1, solo_mission);
         flag = 3;
 
     } else {
@@ -629,7 +630,7 @@ int solo_player_menu(void) {
         do_all_clear();
     }
 
-    if ((mission_re_fly == -1) && is_there_sound && config.music_on && !findparameter("-nomusic")) {
+    if ((mission_re_fly == -1) && is_there_sound && config.music_on && !options.nomusic) {
         sdl_stop_music();
         national_mod = sdl_load_mod_file(modnames[solo_country]);
         if (national_mod == NULL) {
@@ -658,6 +659,7 @@ int solo_player_menu(void) {
             for (l = 0; l <= highest_mission; l++) {
                 if (x >= 23 && x <= 125 && y > (20 + 27 * l) && y < (45 + 27 * l)) {
                     solo_mission = l;
+                    prefetch_next_level(1, solo_mission);
                     if (n1)
                         flag = 1;
                     else
@@ -703,7 +705,7 @@ int solo_player_menu(void) {
         return 1;
 
     case 3:
-        if ((mission_re_fly == -1) && is_there_sound && config.music_on && !findparameter("-nomusic")) {
+        if ((mission_re_fly == -1) && is_there_sound && config.music_on && !options.nomusic) {
             sdl_stop_music();
             sdl_free_mod_file(national_mod);
 
@@ -711,7 +713,7 @@ int solo_player_menu(void) {
         return 2;
 
     case 2:
-        if (is_there_sound && config.music_on && !findparameter("-nomusic")) {
+        if (is_there_sound && config.music_on && !options.nomusic) {
             sdl_stop_music();
             sdl_free_mod_file(national_mod);
 
@@ -2012,6 +2014,8 @@ void transfer_menu(void) {
         delete descs[x];
     }
 
+    prefetch_next_level(0, 0);
+
     delete optionme;
 
 
@@ -2935,7 +2939,7 @@ int kangas_menu(void) {
         }
     }
 
-    if ((mission_re_fly == -1) && is_there_sound && config.music_on && !findparameter("-nomusic")) {
+    if ((mission_re_fly == -1) && is_there_sound && config.music_on && !options.nomusic) {
         sdl_stop_music();
         sdl_free_mod_file(national_mod);
     }
@@ -2968,7 +2972,7 @@ void credits_menu(void) {
     kohta1 = 160 - (grid3->printf(0, 25, "Triplane Turmoil Crew") >> 1);
     kohta2 = 160 - (grid3->printf(0, 25, "Special Thanks:") >> 1);
 
-    if (!findparameter("-debugnographics"))
+    if (!options.debugnographics)
         init_vga("PALET7");
 
     while (!exit_flag) {
@@ -3011,7 +3015,7 @@ void credits_menu(void) {
 
     tyhjaa_vircr();
     do_all();
-    if (!findparameter("-debugnographics"))
+    if (!options.debugnographics)
         init_vga("PALET5");
 
     delete credi1;
@@ -3035,7 +3039,7 @@ void letter_menu(void) {
     medal1 = new Bitmap(1 + 32 * solo_country, 1, 31, 57, temp);
     delete temp;
 
-    if (is_there_sound && config.music_on && !findparameter("-nomusic")) {
+    if (is_there_sound && config.music_on && !options.nomusic) {
         national_mod = sdl_load_mod_file(modnames[solo_country]);
         if (national_mod == NULL) {
             printf("Error locating music.\n");
@@ -3089,7 +3093,7 @@ void letter_menu(void) {
 
     wait_mouse_relase();
 
-    if (is_there_sound && config.music_on && !findparameter("-nomusic")) {
+    if (is_there_sound && config.music_on && !options.nomusic) {
         sdl_stop_music();
         sdl_free_mod_file(national_mod);
     }
@@ -3263,7 +3267,7 @@ void main_menu(void) {
         } else
             do_all();
 
-        if (findparameter("-autostart")) {
+        if (options.autostart) {
             n1 = 1;
             menuselect = 1;
         }
@@ -3293,7 +3297,7 @@ void main_menu(void) {
 
                 FILE *rfile;
 
-                if (findparameter("-record")) {
+                if (options.record) {
                     rfile = settings_open("record.ran", "wb");
                     fwrite(&full_seed, sizeof(full_seed), 1, rfile);
 
@@ -3303,7 +3307,7 @@ void main_menu(void) {
 
                 }
 
-                if (findparameter("-playback")) {
+                if (options.playback) {
                     rfile = settings_open("record.ran", "rb");
                     fread(&full_seed, sizeof(full_seed), 1, rfile);
 
@@ -3379,7 +3383,7 @@ void main_menu(void) {
 
 
 
-                if (is_there_sound && (!findparameter("-nomusic"))) {
+                if (is_there_sound && (!options.nomusic)) {
 
                     sdl_stop_music();
 
@@ -3390,8 +3394,8 @@ void main_menu(void) {
                 wait_mouse_relase();
 
                 if (config.svga && solo_mode == -1)
-                    if (!findparameter("-debugnographics")) {
-                        if (findparameter("-black"))
+                    if (!options.debugnographics) {
+                        if (options.black)
                             init_vesa("PALET3");
                         else
                             init_vesa("PALET5");
@@ -3399,9 +3403,11 @@ void main_menu(void) {
 
                 main_engine();
 
+                if (!playing_solo)
+                    prefetch_next_level(0, 0);
 
                 if (config.svga) {
-                    if (!findparameter("-debugnographics")) {
+                    if (!options.debugnographics) {
 
                         init_vga("PALET5");
                     }
@@ -3409,12 +3415,12 @@ void main_menu(void) {
                     do_all();
                 }
 
-                if (findparameter("-autoquit")) {
+                if (options.autoquit) {
                     exit(1);
                 }
 
-                if (!findparameter("-debugnoaftermath")) {
-                    if (aftermath && !findparameter("-playback")) {
+                if (!options.debugnoaftermath) {
+                    if (aftermath && !options.playback) {
                         if (!(playing_solo && !mission_duration)) {
                             if (playing_solo) {
                                 do_aftermath(1);
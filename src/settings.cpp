@@ -461,10 +461,14 @@ void swap_config_endianes(void) {
 
     config.joystick[1] = SDL_SwapLE32(config.joystick[1]);
     config.joystick_calibrated[1] = SDL_SwapLE32(config.joystick_calibrated[1]);
+
+    config.audio_rate = SDL_SwapLE32(config.audio_rate);
+    config.audio_buffer = SDL_SwapLE32(config.audio_buffer);
 }
 
 void load_config(void) {
     int laskuri;
+    size_t luettu;
     FILE *faili;
 
     config.current_multilevel = 0;
@@ -518,12 +522,21 @@ void load_config(void) {
     config.joystick[1] = -1;
     config.joystick_calibrated[1] = 0;
 
+    config.audio_rate = 44100;
+    config.audio_buffer = 0;
+
     faili = settings_open(CONFIGURATION_FILENAME, "rb");
 
     if (faili != NULL) {
-        fread(&config, sizeof(config), 1, faili);
+        luettu = fread(&config, 1, sizeof(config), faili);
         fclose(faili);
         swap_config_endianes();
+
+        // triplane.cfg from before the audio device settings
+        if (luettu < sizeof(config)) {
+            config.audio_rate = 44100;
+            config.audio_buffer = 0;
+        }
     }
 
     is_there_sound = config.sound_on;
@@ -157,6 +157,9 @@ struct configuration {
     int32_t joystick[2];
     int32_t joystick_calibrated[2];
 
+    // Audio device, last so that older triplane.cfg files still load
+    int32_t audio_rate;
+    int32_t audio_buffer;       // sample frames, 0 = smallest that works
 
 };
 
@@ -0,0 +1,19 @@
+# Converts a file to a C++ array, like dat2c, but runs with CMake
+# itself so that it also works when cross compiling.
+#
+# cmake -DINPUT=file -DOUTPUT=file.cpp -DNAME=symbol -P dat2c.cmake
+#
+# Defines extern const unsigned char NAME[] and
+# extern const unsigned long NAME_koko.
+
+file(READ ${INPUT} hex HEX)
+file(SIZE ${INPUT} koko)
+
+# 32 bytes per line
+string(REGEX REPLACE "([0-9a-f][0-9a-f][0-9a-f][0-9a-f][0-9a-f][0-9a-f][0-9a-f][0-9a-f][0-9a-f][0-9a-f][0-9a-f][0-9a-f][0-9a-f][0-9a-f][0-9a-f][0-9a-f][0-9a-f][0-9a-f][0-9a-f][0-9a-f][0-9a-f][0-9a-f][0-9a-f][0-9a-f][0-9a-f][0-9a-f][0-9a-f][0-9a-f][0-9a-f][0-9a-f][0-9a-f][0-9a-f][0-9a-f][0-9a-f][0-9a-f][0-9a-f][0-9a-f][0-9a-f][0-9a-f][0-9a-f][0-9a-f][0-9a-f][0-9a-f][0-9a-f][0-9a-f][0-9a-f][0-9a-f][0-9a-f][0-9a-f][0-9a-f][0-9a-f][0-9a-f][0-9a-f][0-9a-f][0-9a-f][0-9a-f][0-9a-f][0-9a-f][0-9a-f][0-9a-f][0-9a-f][0-9a-f][0-9a-f][0-9a-f])" "\\1\n" hex "${hex}")
+string(REGEX REPLACE "([0-9a-f][0-9a-f])" "0x\\1," hex "${hex}")
+
+file(WRITE ${OUTPUT}
+    "/* Converted from ${INPUT} by dat2c.cmake */\n\n"
+    "extern const unsigned char ${NAME}[] = {\n${hex}0 };\n\n"
+    "extern const unsigned long ${NAME}_koko = ${koko};\n")
@@ -30,6 +30,8 @@
 #include <string.h>
 #include <time.h>
 #include <stdlib.h>
+#include "io/dksformat.h"
+#include "util/compress.h"
 
 #define MAX_ENTRIES 8192
 
@@ -65,9 +67,316 @@ int filelength(FILE *faili)
 
 }
 
+/*
+ * Entry of the previous version 2 datafile. Entries whose input has
+ * not changed are copied from it as they are instead of packing them
+ * again.
+ */
+struct vanha_entry {
+
+	 char nimi[8];
+	 const uint8_t *data;
+	 uint32_t koko;
+	 uint32_t purettu;
+	 uint32_t pakkaus;
+	 uint32_t crc;
+};
+
+uint8_t *vanha_data=NULL;
+vanha_entry *vanhat=NULL;
+int vanhoja=0;
+
+/*
+ * Read the previous datafile, if there is one and it is a valid
+ * version 2 file. Anything else is quietly ignored and everything
+ * is packed again.
+ */
+void read_previous(const char *file_to_be)
+{
+  FILE *in;
+  unsigned long koko;
+  uint32_t kpl,hakemisto;
+  uint32_t vaihe;
+
+  if( (in=fopen(file_to_be,"rb"))==NULL)
+    return;
+
+  koko=filelength(in);
+  if(koko<DKS_V2_HEADER || (vanha_data=(uint8_t *) malloc(koko))==NULL ||
+     !fread(vanha_data,koko,1,in) ||
+     memcmp(vanha_data,DKS_V2_MAGIC,DKS_V2_MAGIC_KOKO) ||
+     dks_get32(vanha_data+DKS_V2_H_VERSION)!=DKS_V2_VERSION)
+  {
+    fclose(in);
+    free(vanha_data);
+    vanha_data=NULL;
+    return;
+  }
+  fclose(in);
+
+  kpl=dks_get32(vanha_data+DKS_V2_H_KPL);
+  hakemisto=dks_get32(vanha_data+DKS_V2_H_HAKEMISTO);
+  if(hakemisto>koko || kpl>(koko-hakemisto)/DKS_V2_ENTRY ||
+     (vanhat=(vanha_entry *) malloc((kpl ? kpl : 1)*sizeof(vanha_entry)))==NULL)
+  {
+    free(vanha_data);
+    vanha_data=NULL;
+    return;
+  }
+
+  for(vaihe=0;vaihe<kpl;vaihe++)
+  {
+    const uint8_t *entry=vanha_data+hakemisto+vaihe*DKS_V2_ENTRY;
+    uint32_t offset=dks_get32(entry+DKS_V2_E_OFFSET);
+    uint32_t levylla=dks_get32(entry+DKS_V2_E_KOKO);
+
+    if(offset>koko || levylla>koko-offset)
+      continue;
+
+    memcpy(vanhat[vanhoja].nimi,entry,6);
+    vanhat[vanhoja].nimi[6]=0;
+    vanhat[vanhoja].data=vanha_data+offset;
+    vanhat[vanhoja].koko=levylla;
+    vanhat[vanhoja].purettu=dks_get32(entry+DKS_V2_E_PURETTU);
+    vanhat[vanhoja].pakkaus=dks_get32(entry+DKS_V2_E_PAKKAUS);
+    vanhat[vanhoja].crc=dks_get32(entry+DKS_V2_E_CRC);
+    vanhoja++;
+  }
+}
+
+/*
+ * Does the previous entry hold exactly these bytes? A matching CRC is
+ * not proof enough, the stored data is compared as well.
+ */
+int same_as_previous(const vanha_entry *vanha,const uint8_t *data,uint32_t koko)
+{
+  uint8_t *purettu;
+  int sama;
+
+  if(vanha->pakkaus==DKS_PAKKAUS_EI)
+    return vanha->koko==koko && !memcmp(vanha->data,data,koko);
+
+  if(vanha->pakkaus!=DKS_PAKKAUS_LZ)
+    return 0;
+
+  if( (purettu=(uint8_t *) malloc(koko ? koko : 1))==NULL)
+  {
+    printf("Out of memory");
+    exit(1);
+  }
+
+  sama=decompress_block(vanha->data,vanha->koko,purettu,koko) &&
+       !memcmp(purettu,data,koko);
+  free(purettu);
+
+  return sama;
+}
+
+vanha_entry *find_previous(const char *nimi,const uint8_t *data,uint32_t purettu,uint32_t crc)
+{
+  int vaihe;
+
+  for(vaihe=0;vaihe<vanhoja;vaihe++)
+    if(vanhat[vaihe].purettu==purettu && vanhat[vaihe].crc==crc &&
+       !strncmp(vanhat[vaihe].nimi,nimi,6) &&
+       same_as_previous(&vanhat[vaihe],data,purettu))
+      return &vanhat[vaihe];
+
+  return NULL;
+}
+
+/*
+ * Read one input file of koko bytes to a buffer of its own.
+ */
+unsigned char *read_entry(const char *tiedosto,unsigned long koko)
+{
+  FILE *in;
+  unsigned char *data;
+
+  if( (data=(unsigned char *) malloc(koko ? koko : 1))==NULL)
+  {
+    printf("Out of memory");
+    exit(1);
+  }
+
+  if( (in=fopen(tiedosto,"rb"))==NULL)
+  {
+    printf("\n\n Cannon't locate file %s\n",tiedosto);
+    exit(1);
+  }
+
+  if(koko && !fread(data,koko,1,in))
+  {
+    printf("\nError reading file %s.\n",tiedosto);
+    fclose(in);
+
+    exit(1);
+  }
+  fclose(in);
+
+  return data;
+}
+
+void write_or_die(const void *data,unsigned long koko,FILE *out,const char *file_to_be)
+{
+  if(koko && !fwrite(data,koko,1,out))
+  {
+    printf("\nError writing file %s\n",file_to_be);
+    exit(1);
+  }
+}
+
+/*
+ * Write a version 1 datafile. Entry data is streamed to the file one
+ * input at a time and the directory written last.
+ */
+void write_v1(const char *file_to_be,main_directory_entry *dirri,buildaus_info *info,int kpl,const char *tekstia,int tekstia_koko)
+{
+  FILE *out;
+  unsigned char *data;
+  unsigned long offset=tekstia_koko+sizeof(main_directory_entry)*MAX_ENTRIES;
+  int vaihe;
+
+  if( (out=fopen(file_to_be,"wb")) == NULL)
+  {
+    printf("\nError creating file %s\n",file_to_be);
+    exit(1);
+  }
+
+  fseek(out,offset,SEEK_SET);
+
+  for(vaihe=0;vaihe<kpl;vaihe++)
+  {
+    data=read_entry(info[vaihe].tiedosto,dirri[vaihe].koko);
+    write_or_die(data,dirri[vaihe].koko,out,file_to_be);
+    free(data);
+
+    offset+=dirri[vaihe].koko;
+    printf(".");
+    fflush(stdout);
+  }
+
+  fseek(out,0,SEEK_SET);
+  write_or_die(tekstia,tekstia_koko,out,file_to_be);
+  write_or_die(dirri,sizeof(main_directory_entry)*MAX_ENTRIES,out,file_to_be);
+  fclose(out);
+
+  printf("\n%s created. Size: %lu Entries: %d.\n",file_to_be,offset,kpl);
+}
+
+/*
+ * Write a version 2 datafile. Entries are stored packed when that
+ * saves space. An entry whose name and contents match an entry of the
+ * previous datafile is copied from there without packing it again.
+ */
+void write_v2(const char *file_to_be,main_directory_entry *dirri,buildaus_info *info,int kpl)
+{
+  FILE *out;
+  uint8_t header[DKS_V2_HEADER];
+  uint8_t *hakemisto;
+  uint8_t *pakattu;
+  uint8_t nollat[DKS_V2_ALIGN];
+  unsigned long offset;
+  unsigned long levylla=0,purettuna=0;
+  int pakattu_koko,maksimi=0;
+  int vaihe,uudelleen=0;
+
+  read_previous(file_to_be);
+
+  for(vaihe=0;vaihe<kpl;vaihe++)
+    if(compress_bound(dirri[vaihe].koko)>maksimi)
+      maksimi=compress_bound(dirri[vaihe].koko);
+
+  if( (hakemisto=(uint8_t *) calloc(kpl>0 ? kpl : 1,DKS_V2_ENTRY))==NULL ||
+      (pakattu=(uint8_t *) malloc(maksimi ? maksimi : 1))==NULL)
+  {
+    printf("Out of memory");
+    exit(1);
+  }
+
+  memset(header,0,sizeof(header));
+  memset(nollat,0,sizeof(nollat));
+  memcpy(header,DKS_V2_MAGIC,DKS_V2_MAGIC_KOKO);
+  dks_put32(header+DKS_V2_H_VERSION,DKS_V2_VERSION);
+  dks_put32(header+DKS_V2_H_KPL,kpl);
+  dks_put32(header+DKS_V2_H_HAKEMISTO,DKS_V2_HEADER);
+
+  if( (out=fopen(file_to_be,"wb")) == NULL)
+  {
+    printf("\nError creating file %s\n",file_to_be);
+    exit(1);
+  }
+
+  /* Directory is written last, once the offsets are known */
+  offset=DKS_V2_HEADER+(unsigned long)kpl*DKS_V2_ENTRY;
+  fseek(out,offset,SEEK_SET);
+
+  for(vaihe=0;vaihe<kpl;vaihe++)
+  {
+    uint8_t *entry=hakemisto+vaihe*DKS_V2_ENTRY;
+    unsigned char *data=read_entry(info[vaihe].tiedosto,dirri[vaihe].koko);
+    const uint8_t *talteen=data;
+    unsigned long koko=dirri[vaihe].koko;
+    unsigned long tyhjaa=(DKS_V2_ALIGN-offset%DKS_V2_ALIGN)%DKS_V2_ALIGN;
+    uint32_t crc=checksum_crc32(data,koko);
+    uint32_t pakkaus=DKS_PAKKAUS_EI;
+    vanha_entry *vanha=find_previous(dirri[vaihe].nimi,data,koko,crc);
+
+    write_or_die(nollat,tyhjaa,out,file_to_be);
+    offset+=tyhjaa;
+
+    if(vanha!=NULL)
+    {
+      talteen=vanha->data;
+      koko=vanha->koko;
+      pakkaus=vanha->pakkaus;
+      uudelleen++;
+    }
+    else
+    {
+      pakattu_koko=compress_block(data,koko,pakattu,koko);
+
+      if(pakattu_koko>0 && (unsigned long)pakattu_koko<koko)
+      {
+        talteen=pakattu;
+        koko=pakattu_koko;
+        pakkaus=DKS_PAKKAUS_LZ;
+      }
+    }
+
+    strncpy((char *)entry,dirri[vaihe].nimi,6);
+    dks_put32(entry+DKS_V2_E_OFFSET,offset);
+    dks_put32(entry+DKS_V2_E_KOKO,koko);
+    dks_put32(entry+DKS_V2_E_PURETTU,dirri[vaihe].koko);
+    dks_put32(entry+DKS_V2_E_PAKKAUS,pakkaus);
+    dks_put32(entry+DKS_V2_E_CRC,crc);
+
+    write_or_die(talteen,koko,out,file_to_be);
+    free(data);
+
+    offset+=koko;
+    levylla+=koko;
+    purettuna+=dirri[vaihe].koko;
+    printf(".");
+    fflush(stdout);
+  }
+
+  fseek(out,0,SEEK_SET);
+  write_or_die(header,sizeof(header),out,file_to_be);
+  write_or_die(hakemisto,(unsigned long)kpl*DKS_V2_ENTRY,out,file_to_be);
+  fclose(out);
+
+  printf("\n%s created. Size: %lu Entries: %d (%d unchanged). Data %lu bytes packed to %lu.\n",file_to_be,offset,kpl,uudelleen,purettuna,levylla);
+
+  free(hakemisto);
+  free(pakattu);
+  free(vanhat);
+  free(vanha_data);
+}
+
 int main(int argc,char **argv)
 {
-  FILE *in,*out;
+  FILE *in;
   char tekstia[20] = {0};
   int kohtien_lukumaara=0;
   char ch;
@@ -76,11 +385,11 @@ int main(int argc,char **argv)
   int vaihe;
   buildaus_info *info;
   main_directory_entry *dirri;
-  unsigned char *tila; 
   unsigned long koko;
   unsigned long offset; 
   char crypt_key[80]="";
   int reg_number=5324434;
+  int versio=1;
 
   if( (info=(buildaus_info *) malloc (MAX_ENTRIES*sizeof(buildaus_info))) ==NULL)
   { 
@@ -94,17 +403,19 @@ int main(int argc,char **argv)
     exit(1);
   }
 
-  if( (tila=(unsigned char* ) malloc(8000000))==NULL)
+  printf("\nDKS Databuilder 2.1 for Wsystem        Copyright (C) 1996 Wraith\n");
+  
+  if(argc>2 && !strcmp(argv[1],"-2"))
   {
-    printf("Out of memory");
-    exit(1);
+    versio=2;
+    argv++;
+    argc--;
   }
 
-  printf("\nDKS Databuilder 2.1 for Wsystem        Copyright (C) 1996 Wraith\n");
-  
   if(argc<2)
   {
-    printf("\nUSAGE: DKSBUILD indexfilename\n");
+    printf("\nUSAGE: DKSBUILD [-2] indexfilename\n");
+    printf("  -2  write a version 2 datafile with packed, checksummed entries\n");
     exit(1);   
   }
 
@@ -246,55 +557,21 @@ int main(int argc,char **argv)
     }
 
     strcpy(dirri[vaihe].nimi,info[vaihe].nimi);
-    
-    if(!fread(tila+offset-sizeof(tekstia)-sizeof(main_directory_entry)*MAX_ENTRIES,koko,1,in))
-    {
-       printf("\nError reading file %s.\n",info[vaihe].tiedosto);
-       fclose(in);
-
-       exit(1);
-    }
     fclose(in);
 
-
     offset+=koko;
-    printf(".");
-    fflush(stdout);    
   } //for
 
 
-  printf("\n\nTemporary data constructed, writing...\n");
+  printf("\n\nDirectory constructed, writing...\n");
 
-  if( (out=fopen(file_to_be,"wb")) == NULL)
-  {
-    printf("\nError creating file %s\n",file_to_be);
-    exit(1);
-
-  }
-
-
-  if(!fwrite(tekstia,sizeof(tekstia),1,out))
-  {
-    printf("\nError writing file %s\n",file_to_be);
-    exit(1);
-  }
-  
-  if(!fwrite(dirri,sizeof(main_directory_entry)*MAX_ENTRIES,1,out))
-  {
-    printf("\nError writing file %s\n",file_to_be);
-    exit(1);
-  }
-
-  fwrite(tila,offset-20-sizeof(main_directory_entry)*MAX_ENTRIES,1,out);
-  fclose(out);
-  
-
- 
-  printf("\n%s created. Size: %lu Entries: %d.\n",file_to_be,offset,kohtien_lukumaara);
+  if(versio==2)
+    write_v2(file_to_be,dirri,info,kohtien_lukumaara);
+  else
+    write_v1(file_to_be,dirri,info,kohtien_lukumaara,tekstia,sizeof(tekstia));
 
   free(info);
   free(dirri);
-  free(tila);
     
   return (0);
 } // main
@@ -36,20 +36,6 @@
 #include "util/msvc.h"
 #endif
 
-#define MAX_ENTRIES 8192
-
-/* XXXX */
-#pragma pack(1)
-struct main_directory_entry {
-    char nimi[7];
-    unsigned long int offset __attribute__ ((packed));
-    unsigned long int koko __attribute__ ((packed));
-};
-
-#pragma pack()
-
-extern main_directory_entry *dirri;
-
 int main(int argv, char *argc[]) {
     char nimi[30];
     int lask, lask2 = 0;
@@ -77,10 +63,8 @@ int main(int argv, char *argc[]) {
         getch();
     } else {
         printf("\n");
-        for (lask = 0; lask < MAX_ENTRIES; lask++) {
-            if (!dirri[lask].nimi[0])
-                break;
-            printf("%-6s ", dirri[lask].nimi);
+        for (lask = 0; lask < dkscount(); lask++) {
+            printf("%-6s ", dksname(lask));
             lask2++;
             if (lask2 == 10) {
                 lask2 = 0;
@@ -0,0 +1,67 @@
+/* 
+ * Triplane Classic - a side-scrolling dogfighting game.
+ * Copyright (C) 1996,1997,2009  Dodekaedron Software Creations Oy
+ * 
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * tjt@users.sourceforge.net
+ */
+
+/*
+ * Checks squareroot() against the plain Newton iteration it replaced,
+ * for every input from -65536 to 2^24. That covers the whole range of
+ * the direct computation with some margin; beyond it squareroot() runs
+ * the same iteration. Exits with 1 on the first mismatch.
+ */
+
+#include <stdio.h>
+#include "util/wutil.h"
+
+#define ALKU (-65536)
+#define LOPPU (1 << 24)
+
+static int newton_squareroot(int number) {
+    int l, old_result, new_result;
+
+    if (!(old_result = new_result = number >> 1))
+        return 1;
+
+    for (l = 0; l < 14; l++) {
+        new_result = (old_result + number / old_result + 1) >> 1;
+        if (new_result == old_result || !new_result)
+            return new_result;
+
+        old_result = new_result;
+
+    }
+
+    return new_result;
+}
+
+int main(int argc, char *argv[]) {
+    int luku, odotettu, saatu;
+
+    for (luku = ALKU; luku <= LOPPU; luku++) {
+        odotettu = newton_squareroot(luku);
+        saatu = squareroot(luku);
+
+        if (saatu != odotettu) {
+            printf("squareroot(%d) = %d, expected %d\n", luku, saatu, odotettu);
+            return 1;
+        }
+    }
+
+    printf("squareroot() matches for %d to %d\n", ALKU, LOPPU);
+    return 0;
+}
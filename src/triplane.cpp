@@ -33,10 +33,12 @@
 #include "world/tmexept.h"
 #include "world/plane.h"
 #include "world/tripaudio.h"
+#include "world/prefetch.h"
 #include <stdint.h>
 #include <SDL.h>
 #include <SDL_endian.h>
 #include "util/wutil.h"
+#include "util/arena.h"
 #include <time.h>
 #include <string.h>
 #include "io/trip_io.h"
@@ -117,12 +119,17 @@ int player_tsides[16] = { 0, 1, 2, 3, 0, 1, 2, 3, 0, 1, 2, 3, 0, 1, 2, 3 };
 
 int plane_coming[16];
 extern int number_of_planes[16];
+#ifdef TRIPLANE_EMBED_ASSETS
+extern const unsigned char embedded_dks[];
+extern const unsigned long embedded_dks_koko;
+#endif
 extern int miss_plane_direction[16];
 extern int miss_pl_x[16];
 extern int miss_pl_y[16];
 extern int fighter[16];
 
 unsigned char *level_bitmap;
+int level_width = 2400;
 
 int playing_solo;
 int solo_country = 0;
@@ -144,11 +151,6 @@ Font *fontti;
 Font *frost;
 Font *grid2;
 
-//\ Parameter control
-
-char parametrit[40][40];
-int parametri_kpl;
-
 //\ Shots control
 
 int pohja = 0;
@@ -211,7 +213,17 @@ int level_loaded;
 
 //\ Flying objects control
 
-struct flying_objects_data fobjects[MAX_FLYING_OBJECTS];
+int fobjects_x[MAX_FLYING_OBJECTS];
+int fobjects_y[MAX_FLYING_OBJECTS];
+int fobjects_x_speed[MAX_FLYING_OBJECTS];
+int fobjects_y_speed[MAX_FLYING_OBJECTS];
+int fobjects_hit_plane[MAX_FLYING_OBJECTS];
+int fobjects_width[MAX_FLYING_OBJECTS];
+int fobjects_height[MAX_FLYING_OBJECTS];
+int fobjects_type[MAX_FLYING_OBJECTS];
+int fobjects_subtype[MAX_FLYING_OBJECTS];
+int fobjects_phase[MAX_FLYING_OBJECTS];
+int fobjects_owner[MAX_FLYING_OBJECTS];
 
 //\ Scoring data
 
@@ -285,10 +297,8 @@ extern int infan_stop[8];
 
 int computer_active[16] = { 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0 };
 
-int going_left;
-int going_up;
-int terrain_level[2400];
-int wide_terrain_level[2400];
+int *terrain_level = NULL;
+int *wide_terrain_level = NULL;
 int current_mission[16];
 int mission_phase[16];
 int mission_target[16];
@@ -362,7 +372,6 @@ extern char mission_names[24][30];
 //\\\\ Prototypes
 
 void hangarmenu_handle(void);
-int findparameter(const char *jono);
 void controls(void);
 void detect_collision(void);
 void main_engine(void);
@@ -396,11 +405,13 @@ void uninit_sounds(void);
 
 extern void do_infan(void);
 extern void do_kkbase(void);
+extern void build_struct_buckets(void);
 extern void start_it_shot(int x, int y, int angle);
 extern void do_it_shots(void);
 extern void init_mission(int country, int number);
 extern void do_mekan(void);
 
+extern void ai_plane_geometry(void);
 extern void do_ai(int number);
 extern void ai_turn_down(int number);
 extern void ai_turn_up(int number);
@@ -412,7 +423,6 @@ extern "C" {
     extern void init_alkucallback(void);
 }
 
-#define NUMBER_OF_STRUCT_NAMES 35
 #define DESCRIPTION_LENGHT
 
 char struct_names[NUMBER_OF_STRUCT_NAMES * 2][7] = {
@@ -912,16 +922,6 @@ void init_player(int l, int pommit) {
     }
 }
 
-int findparameter(const char *jono) {
-    int laskuri;
-
-    for (laskuri = 1; laskuri < parametri_kpl; laskuri++)
-        if (!strncmp(parametrit[laskuri], jono, strlen(jono)))
-            return (laskuri);
-
-    return (0);
-}
-
 
 
 void controls(void) {
@@ -950,7 +950,7 @@ void controls(void) {
     unsigned char rbyte;
     int rcount;
 
-    if (findparameter("-record")) {
+    if (options.record) {
         for (rcount = 0; rcount < 16; rcount++) {
 
             rbyte = 0;
@@ -970,7 +970,7 @@ void controls(void) {
 
     }
 
-    if (findparameter("-playback")) {
+    if (options.playback) {
         for (rcount = 0; rcount < 16; rcount++) {
             rbyte = record_data[record_counter++];
 
@@ -996,6 +996,8 @@ void controls(void) {
 
 
     if (!(playing_solo && hangarmenu_active[solo_country])) {
+        ai_plane_geometry();
+
         for (l = 0; l < 16; l++) {
 
             if (!player_exists[l])
@@ -1213,6 +1215,8 @@ void controls(void) {
         }
 
     }
+
+    input_latency_apply();
 }
 
 
@@ -1307,7 +1311,7 @@ void detect_collision(void) {
         nx = (player_x[l] + 12 * cosinit[player_angle[l] >> 8]) >> 8;
         ny = (player_y[l] - 12 * sinit[player_angle[l] >> 8]) >> 8;
 
-        if (nx < 0 || nx >= 2400 || ny >= 200) {
+        if (nx < 0 || nx >= level_width || ny >= 200) {
             nx = 0;
             ny = 199;
         }
@@ -1315,7 +1319,7 @@ void detect_collision(void) {
         if (ny < 0)
             ny = 0;
 
-        if (((level_bitmap[nx + ny * 2400]) < 112 || ((level_bitmap[nx + ny * 2400])) > 119) && !in_closing[l] && !player_on_airfield[l]) {
+        if (((level_pixel(nx, ny)) < 112 || ((level_pixel(nx, ny))) > 119) && !in_closing[l] && !player_on_airfield[l]) {
             if (!player_spinning[l]) {
                 player_shots_down[l][l]++;
                 player_points[l]--;
@@ -1326,7 +1330,7 @@ void detect_collision(void) {
             start_parts(l);
 
             if (config.sound_on && config.sfx_on) {
-                if (level_bitmap[nx + ny * 2400] < 231 && level_bitmap[nx + ny * 2400] > 224)
+                if (level_pixel(nx, ny) < 231 && level_pixel(nx, ny) > 224)
                     play_2d_sample(sample_spcrash, player_x_8[solo_country], player_x_8[l]);
                 else
                     play_2d_sample(sample_crash[wrandom(2)], player_x_8[solo_country], player_x_8[l]);
@@ -1348,7 +1352,7 @@ void detect_collision(void) {
         nx = (player_x[l] >> 8) + ((+xxx * cosinit[player_angle[l] >> 8] + yyy * sinit[player_angle[l] >> 8] + 128) >> 8);
         ny = (player_y[l] >> 8) + ((-xxx * sinit[player_angle[l] >> 8] + yyy * cosinit[player_angle[l] >> 8] + 128) >> 8);
 
-        if (nx < 0 || nx >= 2400 || ny >= 200) {
+        if (nx < 0 || nx >= level_width || ny >= 200) {
             nx = 0;
             ny = 199;
         }
@@ -1356,7 +1360,7 @@ void detect_collision(void) {
         if (ny < 0)
             ny = 0;
 
-        if (((level_bitmap[nx + ny * 2400]) < 112 || ((level_bitmap[nx + ny * 2400])) > 119) && !in_closing[l] && !player_on_airfield[l]) {
+        if (((level_pixel(nx, ny)) < 112 || ((level_pixel(nx, ny))) > 119) && !in_closing[l] && !player_on_airfield[l]) {
             if (!player_spinning[l]) {
                 player_shots_down[l][l]++;
                 player_points[l]--;
@@ -1367,7 +1371,7 @@ void detect_collision(void) {
             start_parts(l);
 
             if (config.sound_on && config.sfx_on) {
-                if (level_bitmap[nx + ny * 2400] < 231 && level_bitmap[nx + ny * 2400] > 224)
+                if (level_pixel(nx, ny) < 231 && level_pixel(nx, ny) > 224)
                     play_2d_sample(sample_spcrash, player_x_8[solo_country], player_x_8[l]);
                 else
                     play_2d_sample(sample_crash[wrandom(2)], player_x_8[solo_country], player_x_8[l]);
@@ -1377,14 +1381,45 @@ void detect_collision(void) {
     }
 }
 
+/*
+ * Every frame is simulated and drawn to vircr, but when the loop has
+ * fallen behind the frame pacer its present is left out so that the
+ * following steps run back to back. At most MAX_SKIPPED_PRESENTS in a
+ * row are left out, so the screen keeps updating on a slow machine.
+ */
+#define MAX_SKIPPED_PRESENTS 3
+
+static void schedule_present(void) {
+    static int skipped = 0;
+
+    if (skipped < MAX_SKIPPED_PRESENTS && nopeuskontrolli_behind()) {
+        skip_presents = 1;
+        skipped++;
+    } else {
+        skip_presents = 0;
+        skipped = 0;
+    }
+}
+
+/* With -debuglatency, show the input latency in the corner of the frame */
+static void latency_overlay(void) {
+    frame_stats stats;
+
+    if (!options.debuglatency || frost == NULL)
+        return;
+
+    input_latency_stats(&stats);
+    frost->printf(4, 4, "Input %u ms, p50 %.0f, p99 %.0f", input_latency_last(), stats.p50, stats.p99);
+}
+
 static void solo_do_all(void) {
     int x_offset = 160;
 
     // Compute player's plane location on screen and corresponding
     // offset of the background bitmap
 
-    if (((player_x_8[solo_country]) - x_offset + 320) > NUMBER_OF_SCENES * 160)
-        x_offset -= NUMBER_OF_SCENES * 160 - ((player_x_8[solo_country]) - x_offset + 320);
+    if (((player_x_8[solo_country]) - x_offset + 320) > level_width)
+        x_offset -= level_width - ((player_x_8[solo_country]) - x_offset + 320);
 
     if (((player_x_8[solo_country]) - x_offset) < 0)
         x_offset += player_x_8[solo_country] - x_offset;
@@ -1393,10 +1428,11 @@ static void solo_do_all(void) {
     x_offset = -x_offset;
 
     // draw double bufffer to screen
+    latency_overlay();
     do_all();
 
     // initialize double buffer back to background image
-    // background image 2400x200 (2400 == NUMBER_OF_SCENES*160)
+    // background image level_width x 200
     // surface 320x200
     maisema->blit(-x_offset, 0);
 }
@@ -1424,17 +1460,7 @@ static uint32_t crc32_le(uint32_t crc, unsigned char const *p, size_t len) {
 }
 
 void do_debug_trace(void) {
-    static int first_call = 1;
-    static int enabled = 0;
-
-    if (first_call) {
-        if (findparameter("-debugtrace")) {
-            enabled = 1;
-        }
-        first_call = 0;
-    }
-
-    if (enabled) {
+    if (options.debugtrace) {
         int len;
         uint32_t vircr_checksum;
 
@@ -1451,9 +1477,109 @@ void do_debug_trace(void) {
     }
 }
 
+/*
+ * terrain_level[x] is the lowest row of sky above the ground at x and
+ * wide_terrain_level[x] the minimum of it within 24 pixels. Both are
+ * computed from level_bitmap with the indestructible structures
+ * drawn in. The picture is scanned a row at a time, which reads it
+ * in memory order, until every column has found its ground.
+ */
+static void compute_terrain_level(void) {
+    int *jono;
+    int alku = 0, loppu = 0;
+    int ratkaisematta = level_width;
+    int l, l2;
+    const unsigned char *rivi;
+
+    jono = (int *) walloc(level_width * sizeof(int), WALLOC_LEVEL);
+
+    for (l = 0; l < level_width; l++)
+        terrain_level[l] = -1;
+
+    for (l2 = 0; l2 < 200 && ratkaisematta; l2++) {
+        rivi = level_bitmap + l2 * level_width;
+
+        for (l = 0; l < level_width; l++)
+            if (terrain_level[l] == -1 && (rivi[l] < 112 || rivi[l] > 119)) {
+                terrain_level[l] = (l2 > 0) ? l2 - 1 : 0;
+                ratkaisematta--;
+            }
+    }
+
+    for (l = 0; l < level_width; l++)
+        if (terrain_level[l] == -1)
+            terrain_level[l] = 0;
+
+    // Sliding window minimum: jono holds the columns that can still
+    // be the minimum, with increasing terrain_level
+    for (l = -24; l < level_width; l++) {
+        l2 = l + 24;
+
+        if (l2 < level_width) {
+            while (loppu > alku && terrain_level[jono[loppu - 1]] >= terrain_level[l2])
+                loppu--;
+            jono[loppu++] = l2;
+        }
+
+        if (l >= 0) {
+            while (jono[alku] < l - 24)
+                alku++;
+            wide_terrain_level[l] = terrain_level[jono[alku]];
+        }
+    }
+
+    wfree(jono);
+}
+
+/*
+ * Terrain levels only depend on the level, so they are kept for the
+ * last few levels played. Only levels from the datafile are kept, as
+ * an external level file may change between games. taso holds
+ * terrain_level followed by wide_terrain_level.
+ */
+#define TERRAIN_CACHE_SIZE 8
+
+static struct {
+    char nimi[80];
+    int leveys;
+    int *taso;
+} terrain_cache[TERRAIN_CACHE_SIZE];
+
+static int terrain_cache_seuraava = 0;
+
+static int terrain_cache_get(const char *nimi) {
+    int l;
+
+    for (l = 0; l < TERRAIN_CACHE_SIZE; l++)
+        if (terrain_cache[l].taso != NULL && terrain_cache[l].leveys == level_width && !strcmp(terrain_cache[l].nimi, nimi)) {
+            memcpy(terrain_level, terrain_cache[l].taso, level_width * sizeof(int));
+            memcpy(wide_terrain_level, terrain_cache[l].taso + level_width, level_width * sizeof(int));
+            return 1;
+        }
+
+    return 0;
+}
+
+static void terrain_cache_put(const char *nimi) {
+    int l = terrain_cache_seuraava;
+
+    if (dksentry(nimi, NULL) == NULL)
+        return;
+
+    if (terrain_cache[l].taso != NULL)
+        wfree(terrain_cache[l].taso);
+
+    strcpy(terrain_cache[l].nimi, nimi);
+    terrain_cache[l].leveys = level_width;
+    terrain_cache[l].taso = (int *) walloc(2 * level_width * sizeof(int), WALLOC_LEVEL);
+    memcpy(terrain_cache[l].taso, terrain_level, level_width * sizeof(int));
+    memcpy(terrain_cache[l].taso + level_width, wide_terrain_level, level_width * sizeof(int));
+    terrain_cache_seuraava = (terrain_cache_seuraava + 1) % TERRAIN_CACHE_SIZE;
+}
+
 void main_engine(void) {
     int preview_mode = 0;
-    int l, l2, flag = 1;
+    int l, flag = 1;
     int xx, yy;
 
     quit_flag = 0;
@@ -1581,42 +1707,9 @@ void main_engine(void) {
         board->blit(0, 0);
     }
 
-    for (l = 0; l < 2400; l++) {
-        terrain_level[l] = 0;
-
-        for (l2 = 0; l2 < 200; l2++)
-            if (level_bitmap[l + l2 * 2400] < 112 || level_bitmap[l + l2 * 2400] > 119) {
-                terrain_level[l] = l2 - 1;
-                if (terrain_level[l] < 0)
-                    terrain_level[l] = 0;
-                break;
-            }
-
-
-    }
-
-    for (l = 0; l < 2400; l++) {
-        wide_terrain_level[l] = 200;
-
-        for (l2 = 0; l2 < 25; l2++) {
-            if (l + l2 >= 2400)
-                break;
-
-            if (terrain_level[l + l2] < wide_terrain_level[l])
-                wide_terrain_level[l] = terrain_level[l + l2];
-
-        }
-
-        for (l2 = 0; l2 < 25; l2++) {
-            if (l - l2 < 0)
-                break;
-
-            if (terrain_level[l - l2] < wide_terrain_level[l])
-                wide_terrain_level[l] = terrain_level[l - l2];
-
-        }
-
-
+    if (!terrain_cache_get(levelname)) {
+        compute_terrain_level();
+        terrain_cache_put(levelname);
     }
 
 
@@ -1628,7 +1721,7 @@ void main_engine(void) {
 
     }
 
-    if (findparameter("-pixelhunt"))
+    if (options.pixelhunt)
         setpal_range(NULL, 112, 8);
 
     mission_duration = 0;
@@ -1645,12 +1738,12 @@ void main_engine(void) {
     //// Record
 
 
-    if (findparameter("-record") || findparameter("-playback")) {
-        record_data = (char *) walloc(16 * 24 * 1280);
-        record_random = (int *) walloc(4 * 24 * 1280);
+    if (options.record || options.playback) {
+        record_data = (char *) walloc(16 * 24 * 1280, WALLOC_RECORD);
+        record_random = (int *) walloc(4 * 24 * 1280, WALLOC_RECORD);
     }
 
-    if (findparameter("-playback")) {
+    if (options.playback) {
         record_file = settings_open("record.dta", "rb");
         fread(record_data, 24 * 1280, 16, record_file);
         fclose(record_file);
@@ -1661,13 +1754,24 @@ void main_engine(void) {
         fclose(record_file);
 
     }
+    if (options.record)
+        key_record_start(settings_open("record.key", "wb"), KEY_STREAM_GAME);
+
+    if (options.playback)
+        key_playback_start(settings_open("record.key", "rb"), KEY_STREAM_GAME);
     //// Record
     setwrandom(7);
 
+    present_pipeline(1);
+    input_latency_reset();
+
     while (flag) {
         update_key_state();
+        sdl_sample_frame();
+        schedule_present();
 
         if (is_key(SDLK_PAUSE)) {
+            present_flush();
             // wait until pause key is released, then pressed and released again
             while (is_key(SDLK_PAUSE)) {   // still pressed
                 nopeuskontrolli();
@@ -1686,6 +1790,7 @@ void main_engine(void) {
         // because Pause does not always work reliably
         // (and is not present on all keyboards)
         if (is_key(SDLK_F4)) {
+            present_flush();
             // wait until F4 is released, then pressed and released again
             while (is_key(SDLK_F4)) {      // still pressed
                 nopeuskontrolli();
@@ -1845,6 +1950,7 @@ void main_engine(void) {
         do_debug_trace();
 
         if (current_mode == SVGA_MODE) {
+            latency_overlay();
             do_all_clear(0);    ///
 
         }
@@ -1853,8 +1959,10 @@ void main_engine(void) {
         rotate_water_palet();
 
         if (current_mode == VGA_MODE) {
-            if (solo_mode == -1)
+            if (solo_mode == -1) {
+                latency_overlay();
                 do_all(1);
+            }
         }
 
 
@@ -1869,6 +1977,10 @@ void main_engine(void) {
         }
     }
 
+    skip_presents = 0;
+    present_pipeline(0);
+    key_record_stop(KEY_STREAM_GAME);
+
     wait_relase();
     mission_re_fly = -1;
 
@@ -1877,7 +1989,7 @@ void main_engine(void) {
 
     //// Record
 
-    if (findparameter("-record")) {
+    if (options.record) {
         record_file = settings_open("record.dta", "wb");
         fwrite(record_data, 24 * 1280, 16, record_file);
         fclose(record_file);
@@ -1889,9 +2001,9 @@ void main_engine(void) {
 
     }
 
-    if (findparameter("-record") || findparameter("-playback")) {
-        free(record_data);
-        free(record_random);
+    if (options.record || options.playback) {
+        wfree(record_data);
+        wfree(record_random);
     }
     //// Record
 
@@ -1933,7 +2045,7 @@ void do_aftermath(int show_it_all) {
     mission_re_fly = -1;
 
     if (show_it_all && (!playing_solo)) {
-        if (!findparameter("-debugnographics"))
+        if (!options.debugnographics)
             init_vga("PALET5");
 
         temp = new Bitmap("SCORE");
@@ -2350,7 +2462,7 @@ void do_aftermath(int show_it_all) {
         delete standard_background;
         standard_background = NULL;
 
-        if (!findparameter("-debugnoaftermathfadeout") && l == 0)
+        if (!options.debugnoaftermathfadeout && l == 0)
             random_fade_out();
     }
     save_roster();
@@ -2371,7 +2483,7 @@ void load_up(void) {
 
     init_trigs();
 
-    if (!findparameter("-debugnofonts")) {
+    if (!options.debugnofonts) {
 
         loading_text("Loading fonts.");
         frost = new Font("GRFONT");
@@ -2466,7 +2578,7 @@ void load_up(void) {
 
     loading_text("Loading explosion frames.");
 
-    point1 = (unsigned char *) walloc(61 * 41);
+    point1 = (unsigned char *) walloc(61 * 41, WALLOC_BITMAP);
     for (l = 0; l < 2501; l++)
         point1[l] = converted_explosion[l];
 
@@ -2521,7 +2633,7 @@ void load_up(void) {
     for (l = 0; l < 14; l++) {
         mekan_running[l][0] = new Bitmap(1 + 14 * l, 1, 13, 11, plane1);
 
-        point1 = (unsigned char *) walloc(13 * 11);
+        point1 = (unsigned char *) walloc(13 * 11, WALLOC_BITMAP);
 
         point2 = mekan_running[l][0]->info(&xxx, &yyy);
         mekan_running[l][1] = new Bitmap(13, 11, point1, "mekan1");
@@ -2537,7 +2649,7 @@ void load_up(void) {
     for (l = 0; l < 14; l++) {
         mekan_pushing[0][l][0] = new Bitmap(1 + 14 * l, 1, 13, 11, plane1);
 
-        point1 = (unsigned char *) walloc(13 * 11);
+        point1 = (unsigned char *) walloc(13 * 11, WALLOC_BITMAP);
         point2 = mekan_pushing[0][l][0]->info(&xxx, &yyy);
         mekan_pushing[0][l][1] = new Bitmap(13, 11, point1, "mekan2");
 
@@ -2552,7 +2664,7 @@ void load_up(void) {
     for (l = 0; l < 9; l++) {
         mekan_pushing[1][l][1] = new Bitmap(1 + 14 * l, 1, 13, 11, plane1);
 
-        point1 = (unsigned char *) walloc(13 * 11);
+        point1 = (unsigned char *) walloc(13 * 11, WALLOC_BITMAP);
 
         point2 = mekan_pushing[1][l][1]->info(&xxx, &yyy);
         mekan_pushing[1][l][0] = new Bitmap(13, 11, point1, "mekan3");
@@ -2567,7 +2679,7 @@ void load_up(void) {
 
     loading_text("Loading Infantry");
 
-    if (!findparameter("-debugnoinfantry")) {
+    if (!options.debugnoinfantry) {
 
         plane1 = new Bitmap("INFANT");
 
@@ -2602,7 +2714,7 @@ void load_up(void) {
         loading_text("Mirroring infantry.");
 
         for (l = 0; l < 4; l++) {
-            point1 = (unsigned char *) walloc(15 * 14);
+            point1 = (unsigned char *) walloc(15 * 14, WALLOC_BITMAP);
 
             point2 = infantry_dropping[l][0]->info(&xxx, &yyy);
             infantry_dropping[l][1] = new Bitmap(15, 14, point1, "mirr_inf_dropping");
@@ -2611,7 +2723,7 @@ void load_up(void) {
                 for (yyy = 0; yyy < 14; yyy++)
                     point1[xxx + yyy * 15] = point2[14 - xxx + yyy * 15];
 
-            point1 = (unsigned char *) walloc(15 * 14);
+            point1 = (unsigned char *) walloc(15 * 14, WALLOC_BITMAP);
 
             point2 = infantry_after_drop[l][0]->info(&xxx, &yyy);
             infantry_after_drop[l][1] = new Bitmap(15, 14, point1, "mirr_inf_after_drop");
@@ -2623,7 +2735,7 @@ void load_up(void) {
 
 
             for (l2 = 0; l2 < 12; l2++) {
-                point1 = (unsigned char *) walloc(15 * 14);
+                point1 = (unsigned char *) walloc(15 * 14, WALLOC_BITMAP);
 
                 point2 = infantry_walking[l][0][l2]->info(&xxx, &yyy);
                 infantry_walking[l][1][l2] = new Bitmap(15, 14, point1, "mirr_inf_walking");
@@ -2635,7 +2747,7 @@ void load_up(void) {
             }
 
             for (l2 = 0; l2 < 7; l2++) {
-                point1 = (unsigned char *) walloc(15 * 14);
+                point1 = (unsigned char *) walloc(15 * 14, WALLOC_BITMAP);
 
                 point2 = infantry_dying[l][0][l2]->info(&xxx, &yyy);
                 infantry_dying[l][1][l2] = new Bitmap(15, 14, point1, "mirr_inf_dying");
@@ -2647,7 +2759,7 @@ void load_up(void) {
             }
 
             for (l2 = 0; l2 < 6; l2++) {
-                point1 = (unsigned char *) walloc(15 * 14);
+                point1 = (unsigned char *) walloc(15 * 14, WALLOC_BITMAP);
 
                 point2 = infantry_aiming[l][0][l2]->info(&xxx, &yyy);
                 infantry_aiming[l][1][l2] = new Bitmap(15, 14, point1, "mirr_inf_aiming");
@@ -2657,7 +2769,7 @@ void load_up(void) {
                         point1[xxx + yyy * 15] = point2[14 - xxx + yyy * 15];
 
 
-                point1 = (unsigned char *) walloc(15 * 14);
+                point1 = (unsigned char *) walloc(15 * 14, WALLOC_BITMAP);
                 point2 = infantry_shooting[l][0][l2]->info(&xxx, &yyy);
                 infantry_shooting[l][1][l2] = new Bitmap(15, 14, point1, "mirr_inf_shooting");
 
@@ -2668,7 +2780,7 @@ void load_up(void) {
             }
 
             for (l2 = 0; l2 < 10; l2++) {
-                point1 = (unsigned char *) walloc(15 * 14);
+                point1 = (unsigned char *) walloc(15 * 14, WALLOC_BITMAP);
                 point2 = infantry_wavedeath[l][0][l2]->info(&xxx, &yyy);
                 infantry_wavedeath[l][1][l2] = new Bitmap(15, 14, point1, "mirr_inf_wavedeath");
 
@@ -2678,7 +2790,7 @@ void load_up(void) {
 
 
 
-                point1 = (unsigned char *) walloc(15 * 14);
+                point1 = (unsigned char *) walloc(15 * 14, WALLOC_BITMAP);
 
                 point2 = infantry_bdying[l][0][l2]->info(&xxx, &yyy);
                 infantry_bdying[l][1][l2] = new Bitmap(15, 14, point1, "mirr_inf_bdying");
@@ -2692,7 +2804,7 @@ void load_up(void) {
         }
     }                           // debug
 
-    if (!findparameter("-debugnorotate")) {
+    if (!options.debugnorotate) {
 
         loading_text("Loading and rotating bomb.");
         bomb[0] = new Bitmap("BOMB");
@@ -2731,7 +2843,7 @@ void load_up(void) {
             for (l2 = 0; l2 < 16; l2++)
                 for (l1 = 0; l1 < 4; l1++) {
                     point1 = planes[l1][l2][l3][0]->info(&xxx, &yyy);
-                    point2 = (unsigned char *) walloc(400);
+                    point2 = (unsigned char *) walloc(400, WALLOC_BITMAP);
                     if (!l2) {
                         planes[l1][30][l3][1] = new Bitmap(20, 20, point2, "mirr_plane_1");
                         plane_p[l1][30][l3][1] = point2;
@@ -2748,7 +2860,7 @@ void load_up(void) {
             for (l2 = 45; l2 < 60; l2++)
                 for (l1 = 0; l1 < 4; l1++) {
                     point1 = planes[l1][l2][l3][0]->info(&xxx, &yyy);
-                    point2 = (unsigned char *) walloc(400);
+                    point2 = (unsigned char *) walloc(400, WALLOC_BITMAP);
 
                     planes[l1][90 - l2][l3][1] = new Bitmap(20, 20, point2, "mirr_plane_3");
                     plane_p[l1][90 - l2][l3][1] = point2;
@@ -2764,7 +2876,7 @@ void load_up(void) {
             for (l2 = 0; l2 < 16; l2++)
                 for (l1 = 0; l1 < 4; l1++) {
                     point1 = planes[l1][l2][l3][0]->info(&xxx, &yyy);
-                    point2 = (unsigned char *) walloc(400);
+                    point2 = (unsigned char *) walloc(400, WALLOC_BITMAP);
                     if (!l2) {
                         planes[l1][0][l3][1] = new Bitmap(20, 20, point2, "mirr_plane_4");
                         plane_p[l1][0][l3][1] = point2;
@@ -2781,7 +2893,7 @@ void load_up(void) {
             for (l2 = 45; l2 < 60; l2++)
                 for (l1 = 0; l1 < 4; l1++) {
                     point1 = planes[l1][l2][l3][0]->info(&xxx, &yyy);
-                    point2 = (unsigned char *) walloc(400);
+                    point2 = (unsigned char *) walloc(400, WALLOC_BITMAP);
                     if (!l2) {
                         planes[l1][0][l3][1] = new Bitmap(20, 20, point2, "mirr_plane_6");
                         plane_p[l1][0][l3][1] = point2;
@@ -2798,7 +2910,7 @@ void load_up(void) {
             for (l2 = 16; l2 < 45; l2++)
                 for (l1 = 0; l1 < 4; l1++) {
                     point1 = planes[l1][l2][l3][1]->info(&xxx, &yyy);
-                    point2 = (unsigned char *) walloc(400);
+                    point2 = (unsigned char *) walloc(400, WALLOC_BITMAP);
 
                     planes[l1][60 - l2][l3][0] = new Bitmap(20, 20, point2, "mirr_plane_8");
                     plane_p[l1][60 - l2][l3][0] = point2;
@@ -3036,44 +3148,86 @@ void clean_memory(void) {
 
 }
 
+/*
+ * Name of the level main_engine() loads for a solo mission or, with
+ * solo 0, for the current multiplayer level.
+ */
+static void get_level_name(char *nimi, int solo, int mission) {
+    if (!options.level) {
+        if (!solo) {
+            sprintf(nimi, "level%d", config.current_multilevel + 1);
+        } else {
+            sprintf(nimi, "%d-%d", solo_country, mission);
+
+        }
+    } else {
+        strcpy(nimi, options.level);
+
+    }
+}
+
+/*
+ * Start loading the level that is likely to be played next in the
+ * background. See world/prefetch.cpp.
+ */
+void prefetch_next_level(int solo, int mission) {
+    char nimi[80];
+
+    get_level_name(nimi, solo, mission);
+    prefetch_level(nimi);
+}
+
+/*
+ * Structure picture nimi, copied from the prefetched level if it is
+ * there.
+ */
+static Bitmap *load_structure_bitmap(const char *nimi) {
+    Bitmap *valmis = prefetch_bitmap(nimi);
+    int xx, yy;
+
+    if (valmis == NULL)
+        return new Bitmap(nimi);
+
+    valmis->info(&xx, &yy);
+    return new Bitmap(0, 0, xx, yy, valmis);
+}
+
 void load_level(void) {
     int l, l2, i;
     int xx, yy;
     int c_flag;
+    int prefetched;
     Bitmap *temppic;
 
     loading_text("Loading levelinfo.");
 
-    if (!findparameter("-level")) {
-        if (!playing_solo) {
-            sprintf(levelname, "level%d", config.current_multilevel + 1);
-        } else {
-            sprintf(levelname, "%d-%d", solo_country, solo_mission);
+    get_level_name(levelname, playing_solo, solo_mission);
 
-        }
-    } else {
-        strcpy(levelname, parametrit[findparameter("-level")] + 6);
+    prefetched = prefetch_take_level(levelname, &leveldata, &maisema);
 
-    }
+    // Everything below up to build_struct_buckets() is freed together
+    // by clear_level()
+    level_arena_begin();
 
+    if (!prefetched) {
+        if (!dksopen(levelname)) {
+            loading_text("Loading external level.");
+        } else {
+            dksclose();
 
-    if (!dksopen(levelname)) {
-        loading_text("Loading external level.");
-    } else {
-        dksclose();
+        }
 
-    }
+        if (!extdksopen(levelname)) {
+            printf("\nError locating leveldata %s.\n\n", levelname);
+            exit(1);
 
-    if (!extdksopen(levelname)) {
-        printf("\nError locating leveldata %s.\n\n", levelname);
-        exit(1);
 
+        }
 
+        dksread(&leveldata, sizeof(leveldata));
+        dksclose();
     }
 
-    dksread(&leveldata, sizeof(leveldata));
-    dksclose();
-
     // Byte order conversion
 
     for (i = 0; i < MAX_STRUCTURES; i++) {
@@ -3112,7 +3266,25 @@ void load_level(void) {
 
     loading_text("Loading scenery.");
 
-    maisema = new Bitmap(leveldata.pb_name, 0);
+    if (!prefetched)
+        maisema = new Bitmap(leveldata.pb_name, 0);
+
+    // Levels can be of any width, but the 800x600 overview only has
+    // room for three 800 pixel bands
+    maisema->info(&level_width, &yy);
+
+    if (yy != 200) {
+        printf("\nScenery %s of level %s is not 200 pixels high.\n\n", leveldata.pb_name, levelname);
+        exit(1);
+    }
+
+    if (current_mode == SVGA_MODE && level_width > 2400) {
+        printf("\nLevel %s is too wide for the 800x600 mode.\n\n", levelname);
+        exit(1);
+    }
+
+    terrain_level = (int *) level_alloc(level_width * sizeof(int));
+    wide_terrain_level = (int *) level_alloc(level_width * sizeof(int));
 
     loading_text("Loading structures.");
 
@@ -3236,10 +3408,10 @@ void load_level(void) {
             }
 
             if (leveldata.struct_hit[l]) {
-                structures[l][0] = new Bitmap(leveldata.pd_name[l]);
+                structures[l][0] = load_structure_bitmap(leveldata.pd_name[l]);
 
             } else {
-                temppic = new Bitmap(leveldata.pd_name[l]);
+                temppic = load_structure_bitmap(leveldata.pd_name[l]);
                 temppic->info(&struct_width[l], &struct_heigth[l]);
 
                 structures[l][0] = new Bitmap(leveldata.struct_x[l], leveldata.struct_y[l], struct_width[l], struct_heigth[l], maisema);
@@ -3249,7 +3421,7 @@ void load_level(void) {
 
                 for (l2 = 0; l2 < NUMBER_OF_STRUCT_NAMES; l2++) {
                     if (!strcmp(struct_names[l2 * 2], leveldata.pd_name[l])) {
-                        temppic = new Bitmap(struct_names[l2 * 2 + 1]);
+                        temppic = load_structure_bitmap(struct_names[l2 * 2 + 1]);
 
                         structures[l][1] = new Bitmap(leveldata.struct_x[l], leveldata.struct_y[l], struct_width[l], struct_heigth[l], maisema);
 
@@ -3262,7 +3434,7 @@ void load_level(void) {
 
                 if (l2 == NUMBER_OF_STRUCT_NAMES) {
                     delete structures[l][0];
-                    structures[l][0] = new Bitmap(leveldata.pd_name[l]);
+                    structures[l][0] = load_structure_bitmap(leveldata.pd_name[l]);
                     structures[l][0]->info(&struct_width[l], &struct_heigth[l]);
 
                 }
@@ -3270,6 +3442,10 @@ void load_level(void) {
         }
     }
 
+    build_struct_buckets();
+    level_arena_end();
+    prefetch_release();
+
     for (l = 0; l < 4; l++) {
         if (!leveldata.airfield_x[l]) {
             hangar_x[l] = 0;
@@ -3301,23 +3477,13 @@ void load_level(void) {
 
     loading_text("Updating terrainpointer.");
 
+    // terrain_level is computed in main_engine() once the structures
+    // have been drawn to the scenery
     level_bitmap = maisema->info(&xx, &yy);
 
-    for (l = 0; l < 2400; l++) {
-        terrain_level[l] = 0;
-
-        for (l2 = 199; l2 >= 0; l2--)
-            if (level_bitmap[l + l2 * 2400] >= 112 && level_bitmap[l + l2 * 2400] <= 119) {
-                terrain_level[l] = l2;
-                break;
-            }
-
-
-    }
-
-    if (current_mode == VGA_MODE && !findparameter("-debugnographics")) {
+    if (current_mode == VGA_MODE && !options.debugnographics) {
         loading_text("Initializing screen.");
-        if (!findparameter("-black"))
+        if (!options.black)
             init_vga("PALET5");
         else
             init_vga("PALET3");
@@ -3337,6 +3503,16 @@ void clear_level(void) {
 
     delete maisema;
 
+    terrain_level = NULL;
+    wide_terrain_level = NULL;
+
+    level_arena_release();
+
+    if (options.debugarena)
+        printf("Level arena: peak %lu bytes, %lu bytes reserved\n", (unsigned long) level_arena_peak(), (unsigned long) level_arena_reserved());
+
+    if (options.debugalloc)
+        printf("Allocations: %lu bytes live after clearing the level\n", (unsigned long) walloc_live_bytes());
 }
 
 
@@ -3412,7 +3588,7 @@ void init_data(void) {
         shots_flying_x[l] = 0;
 
     for (l = 0; l < MAX_FLYING_OBJECTS; l++)
-        fobjects[l].x = 0;
+        fobjects_x[l] = 0;
 
     if (playing_solo) {
         for (l = 0; l < 12; l++) {
@@ -3552,41 +3728,41 @@ void init_data(void) {
 }
 
 void handle_parameters(void) {
-    if (findparameter("-reverse"))
+    if (options.reverse)
         reverbed_channels = 1;
 
-    if (findparameter("-nosound")) {
+    if (options.nosound) {
         is_there_sound = 0;
         config.sound_on = 0;
         loading_text("Sounds disabled.");
     }
 
-    if (findparameter("-1")) {
-        window_multiplier_vga = 1;
-    }
+    if (options.audio_rate != -1)
+        sound_rate = options.audio_rate;
 
-    if (findparameter("-2")) {
-        window_multiplier_vga = 2;
-    }
+    if (options.audio_buffer != -1)
+        sound_buffer = options.audio_buffer;
 
-    if (findparameter("-3")) {
-        window_multiplier_vga = 3;
-    }
+    if (options.debugaudiolatency)
+        sdl_audio_latency_log = 1;
+
+    if (options.wavout)
+        sdl_audio_wav_file = options.wavout;
 
-    if (findparameter("-4")) {
-        window_multiplier_vga = 4;
+    if (options.zoom) {
+        window_multiplier_vga = options.zoom;
     }
 
-    if (findparameter("-2svga")) {
-        window_multiplier_svga = 2;
+    if (options.svga_zoom) {
+        window_multiplier_svga = options.svga_zoom;
     }
 
-    if (findparameter("-fullscreen")) {
-        wantfullscreen = 1;
+    if (options.fullscreen != -1) {
+        wantfullscreen = options.fullscreen;
     }
 
-    if (findparameter("-nofullscreen")) {
-        wantfullscreen = 0;
+    if (options.novsync) {
+        wantvsync = 0;
     }
 }
 
@@ -3596,32 +3772,36 @@ int main(int argc, char *argv[]) {
     FILE *faili;
     Bitmap *lakuva1;
 
-    for (laskuri = 0; laskuri < argc; laskuri++)
-        strcpy(parametrit[laskuri], argv[laskuri]);
-
-    parametri_kpl = argc;
-
+    parse_options(argc, argv);
 
-    if (findparameter("-?") || findparameter("-h") || findparameter("--help") || findparameter("-help")) {
+    if (options.help) {
         printf("Triplane Classic " TRIPLANE_VERSION "-" TRIPLANE_SP_VERSION " - a side-scrolling dogfighting game.\n");
         printf("Copyright (C) 1996,1997,2009  Dodekaedron Software Creations Oy\n");
         printf("This program is free software; you may redistribute it under the terms of\n");
         printf("the GNU General Public License version 3 or (at your option) a later version.\n");
         printf("This program has absolutely no warranty.\n\n");
-        printf("-help           Help on options\n");
-        printf("-fullscreen     Start game in fullscreen mode\n");
-        printf("-nofullscreen   Start game in windowed mode (default)\n");
-        printf("-nosound        Start game without sounds\n");
-        printf("-1, -2, -3, -4  Zoom the 320x200-pixel game window 1x, 2x (default), 3x or 4x\n");
-        printf("-2svga          Zoom the 800x600-pixel window 2x to produce 1600x1200-pixel window\n");
+        print_options_help();
         printf("\n");
         exit(0);
     }
 
-    if (findparameter("-loadtexts"))
+    if (options.loadtexts)
         loading_texts = 1;
 
+    if (options.debugalloc)
+        walloc_start_tracking();
+
+    if (options.debugframetimes)
+        atexit(nopeuskontrolli_report);
+
+    if (options.debuglatency)
+        atexit(input_latency_report);
+
+#ifdef TRIPLANE_EMBED_ASSETS
+    if (!dksinit_memory(embedded_dks, embedded_dks_koko)) {
+#else
     if (!dksinit(DKS_FILENAME)) {
+#endif
         printf("\n\nError locating main datafile\n");
         exit(1);
     }
@@ -3634,6 +3814,12 @@ int main(int argc, char *argv[]) {
 
     fs_init();
 
+    if (options.record)
+        key_record_start(settings_open("record.mnu", "wb"), KEY_STREAM_MENU);
+
+    if (options.playback)
+        key_playback_start(settings_open("record.mnu", "rb"), KEY_STREAM_MENU);
+
     load_config();
 
     if (config.fullscreen) {
@@ -3665,10 +3851,10 @@ int main(int argc, char *argv[]) {
 
     loading_text("\nLoading keyset.");
 
-    if (!findparameter("-debugnokeyset"))
+    if (!options.debugnokeyset)
         load_keyset();
 
-    if (findparameter("-speed")) {
+    if (options.speed) {
         nopeuskontrolli_enable(0);
     }
 
@@ -3678,7 +3864,7 @@ int main(int argc, char *argv[]) {
     }
 
     if (is_there_sound) {
-        if (config.music_on && !findparameter("-nomusic")) {
+        if (config.music_on && !options.nomusic) {
             loading_text("Loading music.");
             load_music();
         }
@@ -3717,7 +3903,7 @@ int main(int argc, char *argv[]) {
     }
 
     n1 = 0;
-    while (!n1 && !findparameter("-autostart")) {
+    while (!n1 && !options.autostart) {
         if (kbhit())
             break;
 
@@ -3730,7 +3916,7 @@ int main(int argc, char *argv[]) {
 
     }
 
-    while (kbhit() && !findparameter("-autostart"))
+    while (kbhit() && !options.autostart)
         getch();
 
 
@@ -3750,7 +3936,7 @@ int main(int argc, char *argv[]) {
     delete lakuva1;
 
 
-    while (!kbhit() && !findparameter("-autostart")) {
+    while (!kbhit() && !options.autostart) {
         koords(&x, &y, &n1, &n2);
 
         if (n1 || n2) {
@@ -3761,7 +3947,7 @@ int main(int argc, char *argv[]) {
     }
 #endif
 
-    while (kbhit() && !findparameter("-autostart"))
+    while (kbhit() && !options.autostart)
         getch();
 
 
@@ -3769,7 +3955,7 @@ int main(int argc, char *argv[]) {
     load_roster();
 
     loading_text("\nInitializing VGA and starting game.");
-    if (!findparameter("-debugnographics"))
+    if (!options.debugnographics)
         init_vga("PALET5");
 
     while (kbhit())
@@ -3777,6 +3963,7 @@ int main(int argc, char *argv[]) {
 
     main_menu();
     save_roster();
+    key_record_stop(KEY_STREAM_MENU);
 
     if (music_loaded) {
         sdl_stop_music();
@@ -3792,7 +3979,7 @@ int main(int argc, char *argv[]) {
         uninit_sounds();
     }
 
-    if (findparameter("-writehsfile")) {
+    if (options.writehsfile) {
         faili = settings_open("higsscor.txt", "wt");
 
         fprintf(faili, "Triplane Classic Acelist. Total highscores in Sologame\n\n");
@@ -29,6 +29,7 @@
 #include "gfx/gfx.h"
 #include "io/video.h"
 #include "settings.h"
+#include "util/options.h"
 
 #define DKS_FILENAME "fokker.dks"
 #define CALIBRATION_FILENAME "joystic.dta"
@@ -114,17 +115,16 @@ extern int struct_state[MAX_STRUCTURES];
 extern int struct_width[MAX_STRUCTURES];
 extern int struct_heigth[MAX_STRUCTURES];
 
+#define NUMBER_OF_STRUCT_NAMES 35
+
+extern char struct_names[NUMBER_OF_STRUCT_NAMES * 2][7];
+
 //\ Fonts
 
 extern Font *fontti;
 extern Font *frost;
 extern Font *grid2;
 
-//\ Parameter control
-
-extern char parametrit[40][40];
-extern int parametri_kpl;
-
 //\ Shots control
 
 extern int pohja;
@@ -180,22 +180,17 @@ extern int aftermath;
 
 //\ Flying objects control
 
-struct flying_objects_data {
-    int x;
-    int y;
-    int x_speed;
-    int y_speed;
-    int hit_plane;
-    int width;
-    int height;
-    int type;
-    int subtype;
-    int phase;
-    int owner;
-
-};
-
-extern flying_objects_data fobjects[MAX_FLYING_OBJECTS];
+extern int fobjects_x[MAX_FLYING_OBJECTS];
+extern int fobjects_y[MAX_FLYING_OBJECTS];
+extern int fobjects_x_speed[MAX_FLYING_OBJECTS];
+extern int fobjects_y_speed[MAX_FLYING_OBJECTS];
+extern int fobjects_hit_plane[MAX_FLYING_OBJECTS];
+extern int fobjects_width[MAX_FLYING_OBJECTS];
+extern int fobjects_height[MAX_FLYING_OBJECTS];
+extern int fobjects_type[MAX_FLYING_OBJECTS];
+extern int fobjects_subtype[MAX_FLYING_OBJECTS];
+extern int fobjects_phase[MAX_FLYING_OBJECTS];
+extern int fobjects_owner[MAX_FLYING_OBJECTS];
 
 //\ Scoring data
 
@@ -262,10 +257,8 @@ extern int kkbase_number[MAX_AA_GUNS];
 //\\ Computer players
 
 extern int computer_active[16];
-extern int going_left;
-extern int going_up;
-extern int terrain_level[2400];
-extern int wide_terrain_level[2400];
+extern int *terrain_level;
+extern int *wide_terrain_level;
 extern int current_mission[16];
 extern int mission_phase[16];
 extern int mission_target[16];
@@ -285,6 +278,15 @@ extern int modem_com_port;
 extern int modem_com_speed;
 
 extern unsigned char *level_bitmap;
+extern int level_width;
+
+/*
+ * Scenery pixel at x, y. Callers check that 0 <= x < level_width and
+ * 0 <= y < 200.
+ */
+static inline unsigned char level_pixel(int x, int y) {
+    return level_bitmap[x + y * level_width];
+}
 extern int current_mode;
 
 extern int level_loaded;
@@ -321,11 +323,11 @@ extern int main_engine_random_seed;
 /***************************** Functions **************************************/
 
 extern int small_warning(const char *message);
-extern int findparameter(const char *jono);
 extern void kangas_terrain_to_screen(int leftx);
 extern void main_engine(void);
 extern void do_aftermath(int show_it_all);
 extern void clear_level(void);
+extern void prefetch_next_level(int solo, int mission);
 extern void init_player(int l, int pommit = 1);
 extern void cause_damage(int amount, int plane);
 extern void do_flags(void);
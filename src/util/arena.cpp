@@ -0,0 +1,134 @@
+/* 
+ * Triplane Classic - a side-scrolling dogfighting game.
+ * Copyright (C) 1996,1997,2009  Dodekaedron Software Creations Oy
+ * 
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * tjt@users.sourceforge.net
+ */
+
+#include <assert.h>
+#include <stdio.h>
+#include "util/arena.h"
+
+#define ARENA_BLOCK_SIZE (1024 * 1024)
+#define ARENA_MAX_BLOCKS 64
+#define ARENA_ALIGN 16
+
+struct arena_block {
+    unsigned char *data;
+    size_t koko;
+    size_t kaytetty;
+};
+
+static arena_block arena_blocks[ARENA_MAX_BLOCKS];
+static int arena_block_count = 0;
+static int arena_open = 0;
+static size_t arena_used = 0;
+static size_t arena_peak = 0;
+
+void level_arena_begin(void) {
+    // A level that was never cleared leaves its contents behind
+    if (arena_used)
+        level_arena_release();
+
+    arena_open = 1;
+}
+
+void level_arena_end(void) {
+    arena_open = 0;
+}
+
+void level_arena_release(void) {
+    int l;
+
+    for (l = 0; l < arena_block_count; l++)
+        arena_blocks[l].kaytetty = 0;
+
+    arena_used = 0;
+    arena_open = 0;
+}
+
+void *level_alloc(size_t koko, int tag) {
+    arena_block *block;
+    void *ptr;
+    int l;
+
+    if (!arena_open)
+        return walloc(koko, tag);
+
+    koko = (koko + ARENA_ALIGN - 1) & ~((size_t) ARENA_ALIGN - 1);
+
+    for (l = 0; l < arena_block_count; l++)
+        if (arena_blocks[l].koko - arena_blocks[l].kaytetty >= koko)
+            break;
+
+    if (l == arena_block_count) {
+        if (arena_block_count == ARENA_MAX_BLOCKS) {
+            printf("\nLevel arena is full: %d bytes.\n", (int) level_arena_reserved());
+            exit(1);
+        }
+
+        block = &arena_blocks[arena_block_count++];
+        block->koko = koko > ARENA_BLOCK_SIZE ? koko : ARENA_BLOCK_SIZE;
+        block->data = (unsigned char *) walloc(block->koko, WALLOC_LEVEL);
+        block->kaytetty = 0;
+    }
+
+    block = &arena_blocks[l];
+    ptr = block->data + block->kaytetty;
+    block->kaytetty += koko;
+
+    arena_used += koko;
+    if (arena_used > arena_peak)
+        arena_peak = arena_used;
+
+    return ptr;
+}
+
+int level_arena_owns(const void *ptr) {
+    const unsigned char *p = (const unsigned char *) ptr;
+    int l;
+
+    for (l = 0; l < arena_block_count; l++)
+        if (p >= arena_blocks[l].data && p < arena_blocks[l].data + arena_blocks[l].koko)
+            return 1;
+
+    return 0;
+}
+
+int level_arena_is_open(void) {
+    return arena_open;
+}
+
+void level_free(void *ptr) {
+    assert(ptr != NULL);
+
+    if (!level_arena_owns(ptr))
+        wfree(ptr);
+}
+
+size_t level_arena_peak(void) {
+    return arena_peak;
+}
+
+size_t level_arena_reserved(void) {
+    size_t koko = 0;
+    int l;
+
+    for (l = 0; l < arena_block_count; l++)
+        koko += arena_blocks[l].koko;
+
+    return koko;
+}
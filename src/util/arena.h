@@ -0,0 +1,46 @@
+/* 
+ * Triplane Classic - a side-scrolling dogfighting game.
+ * Copyright (C) 1996,1997,2009  Dodekaedron Software Creations Oy
+ * 
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * tjt@users.sourceforge.net
+ */
+
+#ifndef ARENA_H
+#define ARENA_H
+#include <stdlib.h>
+#include "util/wutil.h"
+
+/*
+ * Level arena. Everything allocated with level_alloc() between
+ * level_arena_begin() and level_arena_end() lives until
+ * level_arena_release(), which drops it all at once. The blocks are
+ * kept and reused by the next level. Outside that window level_alloc()
+ * is plain walloc() with the given accounting tag.
+ */
+
+void level_arena_begin(void);
+void level_arena_end(void);
+void level_arena_release(void);
+
+void *level_alloc(size_t koko, int tag = WALLOC_LEVEL);
+void level_free(void *ptr);
+int level_arena_owns(const void *ptr);
+int level_arena_is_open(void);
+
+size_t level_arena_peak(void);
+size_t level_arena_reserved(void);
+
+#endif
@@ -0,0 +1,235 @@
+/* 
+ * Triplane Classic - a side-scrolling dogfighting game.
+ * Copyright (C) 1996,1997,2009  Dodekaedron Software Creations Oy
+ * 
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * tjt@users.sourceforge.net
+ */
+
+#include <string.h>
+#include "util/compress.h"
+
+/*
+ * A block is a list of sequences. Each sequence starts with a token
+ * whose high nibble is the literal count and low nibble the match
+ * length minus four; a nibble of 15 is continued with bytes that are
+ * added to it until one is below 255. The literals follow, then a
+ * little endian 16-bit offset back into the output and the match
+ * length continuation. The last sequence has only literals.
+ */
+
+#define MIN_MATCH 4
+#define LAST_LITERALS 5
+#define MATCH_LIMIT 12
+#define MAX_OFFSET 65535
+#define HASH_BITS 12
+
+static uint32_t crc_taulu[256];
+static int crc_taulu_valmis = 0;
+
+static uint32_t read32(const uint8_t *p) {
+    uint32_t arvo;
+
+    memcpy(&arvo, p, 4);
+    return arvo;
+}
+
+static int write_length(uint8_t *kohde, int kohta, int max_koko, int pituus) {
+    while (pituus >= 255) {
+        if (kohta >= max_koko)
+            return -1;
+        kohde[kohta++] = 255;
+        pituus -= 255;
+    }
+
+    if (kohta >= max_koko)
+        return -1;
+    kohde[kohta++] = pituus;
+
+    return kohta;
+}
+
+/*
+ * Write one sequence. Returns the new output position or -1 if the
+ * output does not fit. offset 0 writes the final literal-only sequence.
+ */
+static int write_sequence(uint8_t *kohde, int kohta, int max_koko, const uint8_t *literaalit, int literaaleja, int offset, int pituus) {
+    int token;
+
+    if (kohta >= max_koko)
+        return -1;
+
+    token = (literaaleja < 15 ? literaaleja : 15) << 4;
+    if (offset)
+        token |= (pituus - MIN_MATCH < 15 ? pituus - MIN_MATCH : 15);
+    kohde[kohta++] = token;
+
+    if (literaaleja >= 15 && (kohta = write_length(kohde, kohta, max_koko, literaaleja - 15)) == -1)
+        return -1;
+
+    if (literaaleja > max_koko - kohta)
+        return -1;
+    memcpy(kohde + kohta, literaalit, literaaleja);
+    kohta += literaaleja;
+
+    if (!offset)
+        return kohta;
+
+    if (max_koko - kohta < 2)
+        return -1;
+    kohde[kohta++] = offset & 0xff;
+    kohde[kohta++] = offset >> 8;
+
+    if (pituus - MIN_MATCH >= 15 && (kohta = write_length(kohde, kohta, max_koko, pituus - MIN_MATCH - 15)) == -1)
+        return -1;
+
+    return kohta;
+}
+
+int compress_bound(int koko) {
+    return koko + koko / 255 + 16;
+}
+
+/*
+ * Compress koko bytes from lahde to kohde. Returns the compressed size
+ * or 0 if it would not fit in max_koko bytes.
+ */
+int compress_block(const uint8_t *lahde, int koko, uint8_t *kohde, int max_koko) {
+    int hajautus[1 << HASH_BITS];
+    int kohta = 0, alku = 0, ulos = 0;
+    int lask;
+
+    for (lask = 0; lask < (1 << HASH_BITS); lask++)
+        hajautus[lask] = -1;
+
+    while (kohta < koko - MATCH_LIMIT) {
+        uint32_t sana = read32(lahde + kohta);
+        unsigned int paikka = (sana * 2654435761u) >> (32 - HASH_BITS);
+        int viite = hajautus[paikka];
+        int pituus;
+
+        hajautus[paikka] = kohta;
+
+        if (viite < 0 || kohta - viite > MAX_OFFSET || read32(lahde + viite) != sana) {
+            kohta++;
+            continue;
+        }
+
+        pituus = MIN_MATCH;
+        while (kohta + pituus < koko - LAST_LITERALS && lahde[viite + pituus] == lahde[kohta + pituus])
+            pituus++;
+
+        ulos = write_sequence(kohde, ulos, max_koko, lahde + alku, kohta - alku, kohta - viite, pituus);
+        if (ulos == -1)
+            return 0;
+
+        kohta += pituus;
+        alku = kohta;
+    }
+
+    ulos = write_sequence(kohde, ulos, max_koko, lahde + alku, koko - alku, 0, 0);
+    if (ulos == -1)
+        return 0;
+
+    return ulos;
+}
+
+static int read_length(const uint8_t *lahde, int koko, int *kohta, int *pituus) {
+    int tavu;
+
+    do {
+        if (*kohta >= koko)
+            return 0;
+        tavu = lahde[(*kohta)++];
+        *pituus += tavu;
+    } while (tavu == 255);
+
+    return 1;
+}
+
+/*
+ * Decompress a block to exactly kohde_koko bytes. Returns 1 on success
+ * and 0 if the block is malformed or decodes to some other size.
+ */
+int decompress_block(const uint8_t *lahde, int koko, uint8_t *kohde, int kohde_koko) {
+    int kohta = 0, ulos = 0;
+
+    while (kohta < koko) {
+        int token = lahde[kohta++];
+        int literaaleja = token >> 4;
+        int pituus = token & 15;
+        int offset;
+
+        if (literaaleja == 15 && !read_length(lahde, koko, &kohta, &literaaleja))
+            return 0;
+
+        if (literaaleja > koko - kohta || literaaleja > kohde_koko - ulos)
+            return 0;
+
+        memcpy(kohde + ulos, lahde + kohta, literaaleja);
+        kohta += literaaleja;
+        ulos += literaaleja;
+
+        if (kohta == koko)
+            break;
+
+        if (koko - kohta < 2)
+            return 0;
+        offset = lahde[kohta] | (lahde[kohta + 1] << 8);
+        kohta += 2;
+
+        if (offset == 0 || offset > ulos)
+            return 0;
+
+        if (pituus == 15 && !read_length(lahde, koko, &kohta, &pituus))
+            return 0;
+        pituus += MIN_MATCH;
+
+        if (pituus > kohde_koko - ulos)
+            return 0;
+
+        /* Matches may overlap their own output */
+        while (pituus--) {
+            kohde[ulos] = kohde[ulos - offset];
+            ulos++;
+        }
+    }
+
+    return ulos == kohde_koko;
+}
+
+uint32_t checksum_crc32(const uint8_t *data, uint32_t koko) {
+    uint32_t crc = 0xffffffff;
+    uint32_t lask;
+
+    if (!crc_taulu_valmis) {
+        for (lask = 0; lask < 256; lask++) {
+            uint32_t arvo = lask;
+            int bitti;
+
+            for (bitti = 0; bitti < 8; bitti++)
+                arvo = (arvo >> 1) ^ (0xedb88320 & (0 - (arvo & 1)));
+
+            crc_taulu[lask] = arvo;
+        }
+
+        crc_taulu_valmis = 1;
+    }
+
+    for (lask = 0; lask < koko; lask++)
+        crc = crc_taulu[(crc ^ data[lask]) & 0xff] ^ (crc >> 8);
+
+    return ~crc;
+}
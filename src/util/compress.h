@@ -0,0 +1,35 @@
+/* 
+ * Triplane Classic - a side-scrolling dogfighting game.
+ * Copyright (C) 1996,1997,2009  Dodekaedron Software Creations Oy
+ * 
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * tjt@users.sourceforge.net
+ */
+
+#ifndef COMPRESS_H
+#define COMPRESS_H
+#include <stdint.h>
+
+/*
+ * Byte oriented LZ77 block codec in the LZ4 block layout and a
+ * CRC-32, used for DKS v2 datafile entries.
+ */
+
+int compress_bound(int koko);
+int compress_block(const uint8_t *lahde, int koko, uint8_t *kohde, int max_koko);
+int decompress_block(const uint8_t *lahde, int koko, uint8_t *kohde, int kohde_koko);
+uint32_t checksum_crc32(const uint8_t *data, uint32_t koko);
+
+#endif
@@ -0,0 +1,188 @@
+/* 
+ * Triplane Classic - a side-scrolling dogfighting game.
+ * Copyright (C) 1996,1997,2009  Dodekaedron Software Creations Oy
+ * 
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * tjt@users.sourceforge.net
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "util/options.h"
+
+command_options options;
+
+enum option_type {
+    OPTION_SET,                 /* -x sets the field to arvo */
+    OPTION_INT,                 /* -x n, minimi <= n <= maksimi, or 0 if arvo is set */
+    OPTION_STRING,              /* -x text */
+    OPTION_SUFFIX               /* -xtext, at most maksimi characters */
+};
+
+struct option_entry {
+    const char *nimi;
+    option_type tyyppi;
+    int *kentta;
+    const char **teksti;
+    int arvo;
+    int minimi, maksimi;
+    const char *otsikko;        /* shown in help instead of nimi */
+    const char *ohje;           /* NULL leaves the option out of help */
+};
+
+#define FLAG(nimi, kentta, arvo, otsikko, ohje) \
+    { nimi, OPTION_SET, &options.kentta, NULL, arvo, 0, 0, otsikko, ohje }
+#define NUMBER(nimi, kentta, nolla, minimi, maksimi, otsikko, ohje) \
+    { nimi, OPTION_INT, &options.kentta, NULL, nolla, minimi, maksimi, otsikko, ohje }
+#define TEXT(nimi, tyyppi, kentta, maksimi, otsikko, ohje) \
+    { nimi, tyyppi, NULL, &options.kentta, 0, 0, maksimi, otsikko, ohje }
+
+static const option_entry option_table[] = {
+    FLAG("-help", help, 1, NULL, "Help on options"),
+    FLAG("-h", help, 1, NULL, NULL),
+    FLAG("-?", help, 1, NULL, NULL),
+    FLAG("--help", help, 1, NULL, NULL),
+    FLAG("-fullscreen", fullscreen, 1, NULL, "Start game in fullscreen mode"),
+    FLAG("-nofullscreen", fullscreen, 0, NULL, "Start game in windowed mode (default)"),
+    FLAG("-nosound", nosound, 1, NULL, "Start game without sounds"),
+    FLAG("-1", zoom, 1, "-1, -2, -3, -4", "Zoom the 320x200-pixel game window 1x, 2x (default), 3x or 4x"),
+    FLAG("-2", zoom, 2, NULL, NULL),
+    FLAG("-3", zoom, 3, NULL, NULL),
+    FLAG("-4", zoom, 4, NULL, NULL),
+    FLAG("-2svga", svga_zoom, 2, NULL, "Zoom the 800x600-pixel window 2x to produce 1600x1200-pixel window"),
+    FLAG("-novsync", novsync, 1, NULL, "Do not wait for the vertical retrace during play"),
+    // The ranges are those init_sounds() accepts
+    NUMBER("-audiorate", audio_rate, 0, 8000, 96000, "-audiorate n", "Audio sample rate in Hz (default 44100)"),
+    NUMBER("-audiobuffer", audio_buffer, 1, 64, 16384, "-audiobuffer n", "Audio buffer in sample frames, 0 picks the smallest that works"),
+    TEXT("-wavout", OPTION_STRING, wavout, 0, "-wavout file", "Write the game audio to a WAV file instead of playing it"),
+    FLAG("-nomusic", nomusic, 1, NULL, NULL),
+    FLAG("-reverse", reverse, 1, NULL, NULL),
+
+    FLAG("-speed", speed, 1, NULL, NULL),
+    FLAG("-loadtexts", loadtexts, 1, NULL, NULL),
+    FLAG("-black", black, 1, NULL, NULL),
+    FLAG("-pixelhunt", pixelhunt, 1, NULL, NULL),
+    FLAG("-autostart", autostart, 1, NULL, NULL),
+    FLAG("-autoquit", autoquit, 1, NULL, NULL),
+    FLAG("-writehsfile", writehsfile, 1, NULL, NULL),
+    TEXT("-level", OPTION_SUFFIX, level, 79, NULL, NULL),
+    NUMBER("-solomenumission", solomenumission, 0, 0, 99, NULL, NULL),
+    FLAG("-record", record, 1, NULL, NULL),
+    FLAG("-playback", playback, 1, NULL, NULL),
+
+    FLAG("-debugtrace", debugtrace, 1, NULL, NULL),
+    FLAG("-debugalloc", debugalloc, 1, NULL, NULL),
+    FLAG("-debugarena", debugarena, 1, NULL, NULL),
+    FLAG("-debugframetimes", debugframetimes, 1, NULL, NULL),
+    FLAG("-debugaudiolatency", debugaudiolatency, 1, NULL, NULL),
+    FLAG("-debuglatency", debuglatency, 1, NULL, NULL),
+    FLAG("-debugnographics", debugnographics, 1, NULL, NULL),
+    FLAG("-debugnofonts", debugnofonts, 1, NULL, NULL),
+    FLAG("-debugnokeyset", debugnokeyset, 1, NULL, NULL),
+    FLAG("-debugnoinfantry", debugnoinfantry, 1, NULL, NULL),
+    FLAG("-debugnorotate", debugnorotate, 1, NULL, NULL),
+    FLAG("-debugnoaftermath", debugnoaftermath, 1, NULL, NULL),
+    FLAG("-debugnoaftermathfadeout", debugnoaftermathfadeout, 1, NULL, NULL),
+};
+
+#define OPTION_COUNT ((int) (sizeof(option_table) / sizeof(option_table[0])))
+
+static const option_entry *find_option(const char *arg) {
+    int l;
+
+    for (l = 0; l < OPTION_COUNT; l++) {
+        const option_entry *o = &option_table[l];
+
+        if (o->tyyppi == OPTION_SUFFIX) {
+            if (!strncmp(arg, o->nimi, strlen(o->nimi)))
+                return o;
+        } else if (!strcmp(arg, o->nimi)) {
+            return o;
+        }
+    }
+
+    return NULL;
+}
+
+void parse_options(int argc, char *argv[]) {
+    const option_entry *o;
+    char *loppu;
+    long luku;
+    int l;
+
+    memset(&options, 0, sizeof(options));
+    options.fullscreen = -1;
+    options.audio_rate = -1;
+    options.audio_buffer = -1;
+    options.solomenumission = -1;
+
+    for (l = 1; l < argc; l++) {
+        o = find_option(argv[l]);
+
+        if (o == NULL) {
+            printf("Unknown option %s, see -help\n", argv[l]);
+            continue;
+        }
+
+        switch (o->tyyppi) {
+        case OPTION_SET:
+            *o->kentta = o->arvo;
+            break;
+
+        case OPTION_INT:
+            if (l + 1 >= argc) {
+                printf("Option %s needs a number\n", o->nimi);
+                exit(1);
+            }
+
+            luku = strtol(argv[++l], &loppu, 10);
+            if (*argv[l] == 0 || *loppu != 0 ||
+                ((luku < o->minimi || luku > o->maksimi) && !(luku == 0 && o->arvo))) {
+                printf("Option %s needs a number between %d and %d%s\n", o->nimi, o->minimi, o->maksimi, o->arvo ? ", or 0" : "");
+                exit(1);
+            }
+
+            *o->kentta = (int) luku;
+            break;
+
+        case OPTION_STRING:
+            if (l + 1 >= argc) {
+                printf("Option %s needs an argument\n", o->nimi);
+                exit(1);
+            }
+
+            *o->teksti = argv[++l];
+            break;
+
+        case OPTION_SUFFIX:
+            *o->teksti = argv[l] + strlen(o->nimi);
+
+            if (**o->teksti == 0 || (int) strlen(*o->teksti) > o->maksimi) {
+                printf("Option %s needs 1 to %d characters right after it, as in %sname\n", o->nimi, o->maksimi, o->nimi);
+                exit(1);
+            }
+            break;
+        }
+    }
+}
+
+void print_options_help(void) {
+    int l;
+
+    for (l = 0; l < OPTION_COUNT; l++)
+        if (option_table[l].ohje != NULL)
+            printf("%-15s %s\n", option_table[l].otsikko ? option_table[l].otsikko : option_table[l].nimi, option_table[l].ohje);
+}
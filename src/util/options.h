@@ -0,0 +1,78 @@
+/* 
+ * Triplane Classic - a side-scrolling dogfighting game.
+ * Copyright (C) 1996,1997,2009  Dodekaedron Software Creations Oy
+ * 
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * tjt@users.sourceforge.net
+ */
+
+#ifndef OPTIONS_H
+#define OPTIONS_H
+
+/*
+ * Command line options. parse_options() reads argv once at startup into
+ * options; the rest of the game only reads its fields. Flags are 0 or 1,
+ * numbers and strings not given on the command line are -1 and NULL.
+ */
+
+struct command_options {
+    int help;
+
+    int fullscreen;             /* -1 = not given, else 0 or 1 */
+    int zoom;
+    int svga_zoom;
+    int novsync;
+
+    int nosound;
+    int nomusic;
+    int reverse;
+    int audio_rate;
+    int audio_buffer;
+    const char *wavout;
+
+    int speed;
+    int loadtexts;
+    int black;
+    int pixelhunt;
+    int autostart;
+    int autoquit;
+    int writehsfile;
+    const char *level;
+    int solomenumission;
+
+    int record;
+    int playback;
+
+    int debugtrace;
+    int debugalloc;
+    int debugarena;
+    int debugframetimes;
+    int debugaudiolatency;
+    int debuglatency;
+    int debugnographics;
+    int debugnofonts;
+    int debugnokeyset;
+    int debugnoinfantry;
+    int debugnorotate;
+    int debugnoaftermath;
+    int debugnoaftermathfadeout;
+};
+
+extern command_options options;
+
+void parse_options(int argc, char *argv[]);
+void print_options_help(void);
+
+#endif
@@ -22,6 +22,7 @@
 #include <assert.h>
 #include <stdlib.h>
 #include <stdio.h>
+#include <math.h>
 #include "triplane.h"
 #include "io/dksfile.h"
 #include "random.h"
@@ -31,6 +32,13 @@
 #define SIN_COS_NRO 361
 #define ASIN_NRO 257
 
+/*
+ * Below this squareroot() converges within its 14 Newton steps to
+ * sqrt(number) rounded to nearest, which is what isqrt_rounded()
+ * computes directly. Larger values run the original iteration.
+ */
+#define SQUAREROOT_EXACT_LIMIT 13560804
+
 int32_t cosinit[SIN_COS_NRO];
 int32_t sinit[SIN_COS_NRO];
 int32_t asinit[ASIN_NRO];
@@ -94,7 +102,132 @@ void wrandom_sanity_check(void) {
     }
 }
 
-void *walloc(size_t size) {
+/*
+ * walloc() accounting, started with -debugalloc. Live blocks are kept
+ * in an open addressed table keyed by address. Memory allocated before
+ * tracking started, or released with plain free(), is not seen.
+ */
+
+struct walloc_entry {
+    void *ptr;
+    size_t koko;
+    int tag;
+};
+
+static const char *walloc_tag_names[WALLOC_TAGS] = {
+    "other", "bitmap", "sample", "level", "font", "record", "datafile"
+};
+
+static int walloc_tracked = 0;
+static SDL_mutex *walloc_lukko = NULL;
+static walloc_entry *walloc_taulu = NULL;
+static size_t walloc_taulu_koko = 0;
+static size_t walloc_taulu_kpl = 0;
+static walloc_stat walloc_tilasto[WALLOC_TAGS];
+static size_t walloc_elossa = 0;
+static size_t walloc_huippu = 0;
+
+static size_t walloc_hash(const void *ptr) {
+    size_t h = (size_t) ptr >> 4;
+
+    h *= 2654435761u;
+    return (h ^ (h >> 15)) & (walloc_taulu_koko - 1);
+}
+
+static size_t walloc_find(const void *ptr) {
+    size_t i = walloc_hash(ptr);
+
+    while (walloc_taulu[i].ptr != NULL && walloc_taulu[i].ptr != ptr)
+        i = (i + 1) & (walloc_taulu_koko - 1);
+
+    return i;
+}
+
+static void walloc_grow(void) {
+    walloc_entry *vanha = walloc_taulu;
+    size_t vanha_koko = walloc_taulu_koko;
+    size_t l;
+
+    walloc_taulu_koko = vanha_koko ? vanha_koko * 2 : 4096;
+    walloc_taulu = (walloc_entry *) calloc(walloc_taulu_koko, sizeof(walloc_entry));
+
+    if (walloc_taulu == NULL) {
+        printf("\nError in memory allocation: %d bytes.\n", (int) (walloc_taulu_koko * sizeof(walloc_entry)));
+        exit(1);
+    }
+
+    for (l = 0; l < vanha_koko; l++)
+        if (vanha[l].ptr != NULL)
+            walloc_taulu[walloc_find(vanha[l].ptr)] = vanha[l];
+
+    free(vanha);
+}
+
+static void walloc_add(int tag, size_t koko) {
+    walloc_tilasto[tag].live++;
+    walloc_tilasto[tag].live_bytes += koko;
+    if (walloc_tilasto[tag].live_bytes > walloc_tilasto[tag].peak_bytes)
+        walloc_tilasto[tag].peak_bytes = walloc_tilasto[tag].live_bytes;
+
+    walloc_elossa += koko;
+    if (walloc_elossa > walloc_huippu)
+        walloc_huippu = walloc_elossa;
+}
+
+static void walloc_remove(int tag, size_t koko) {
+    walloc_tilasto[tag].live--;
+    walloc_tilasto[tag].live_bytes -= koko;
+    walloc_elossa -= koko;
+}
+
+static void walloc_insert(void *ptr, size_t koko, int tag) {
+    size_t i;
+
+    if ((walloc_taulu_kpl + 1) * 2 > walloc_taulu_koko)
+        walloc_grow();
+
+    i = walloc_find(ptr);
+    if (walloc_taulu[i].ptr == NULL)
+        walloc_taulu_kpl++;
+    else
+        walloc_remove(walloc_taulu[i].tag, walloc_taulu[i].koko);
+
+    walloc_taulu[i].ptr = ptr;
+    walloc_taulu[i].koko = koko;
+    walloc_taulu[i].tag = tag;
+
+    walloc_tilasto[tag].allocations++;
+    walloc_add(tag, koko);
+}
+
+static void walloc_erase(void *ptr) {
+    size_t i, j, k;
+    size_t maski = walloc_taulu_koko - 1;
+
+    if (walloc_taulu == NULL)
+        return;
+
+    i = walloc_find(ptr);
+    if (walloc_taulu[i].ptr == NULL)
+        return;
+
+    walloc_remove(walloc_taulu[i].tag, walloc_taulu[i].koko);
+    walloc_taulu_kpl--;
+
+    // Shift the rest of the probe run back over the hole
+    for (j = (i + 1) & maski; walloc_taulu[j].ptr != NULL; j = (j + 1) & maski) {
+        k = walloc_hash(walloc_taulu[j].ptr);
+
+        if ((j > i && (k <= i || k > j)) || (j < i && k <= i && k > j)) {
+            walloc_taulu[i] = walloc_taulu[j];
+            i = j;
+        }
+    }
+
+    walloc_taulu[i].ptr = NULL;
+}
+
+void *walloc(size_t size, int tag) {
     void *ptr;
     ptr = malloc(size);
 
@@ -104,15 +237,96 @@ void *walloc(size_t size) {
 
     }
 
+    if (walloc_tracked) {
+        SDL_LockMutex(walloc_lukko);
+        walloc_insert(ptr, size, tag);
+        SDL_UnlockMutex(walloc_lukko);
+    }
+
     return ptr;
 }
 
 
 void wfree(void *ptr) {
     assert(ptr != NULL);
+
+    if (walloc_tracked) {
+        SDL_LockMutex(walloc_lukko);
+        walloc_erase(ptr);
+        SDL_UnlockMutex(walloc_lukko);
+    }
+
     free(ptr);
 }
 
+void walloc_start_tracking(void) {
+    if (walloc_tracked)
+        return;
+
+    walloc_lukko = SDL_CreateMutex();
+    walloc_tracked = 1;
+    atexit(walloc_report);
+}
+
+/* Count the block at ptr under tag from now on. */
+void walloc_retag(void *ptr, int tag) {
+    size_t i;
+
+    if (!walloc_tracked)
+        return;
+
+    SDL_LockMutex(walloc_lukko);
+
+    if (walloc_taulu != NULL) {
+        i = walloc_find(ptr);
+
+        if (walloc_taulu[i].ptr != NULL) {
+            walloc_remove(walloc_taulu[i].tag, walloc_taulu[i].koko);
+            walloc_tilasto[walloc_taulu[i].tag].allocations--;
+            walloc_taulu[i].tag = tag;
+            walloc_tilasto[tag].allocations++;
+            walloc_add(tag, walloc_taulu[i].koko);
+        }
+    }
+
+    SDL_UnlockMutex(walloc_lukko);
+}
+
+void walloc_stats(int tag, walloc_stat * stat) {
+    assert(tag >= 0 && tag < WALLOC_TAGS);
+
+    SDL_LockMutex(walloc_lukko);
+    *stat = walloc_tilasto[tag];
+    SDL_UnlockMutex(walloc_lukko);
+}
+
+size_t walloc_live_bytes(void) {
+    size_t elossa;
+
+    SDL_LockMutex(walloc_lukko);
+    elossa = walloc_elossa;
+    SDL_UnlockMutex(walloc_lukko);
+
+    return elossa;
+}
+
+/* Live and peak bytes per tag. At exit, the live blocks are leaks. */
+void walloc_report(void) {
+    int l;
+
+    if (!walloc_tracked)
+        return;
+
+    SDL_LockMutex(walloc_lukko);
+
+    printf("Allocations  total     live    live bytes    peak bytes\n");
+    for (l = 0; l < WALLOC_TAGS; l++)
+        printf("%-9s %8lu %8lu %13lu %13lu\n", walloc_tag_names[l], walloc_tilasto[l].allocations, walloc_tilasto[l].live, (unsigned long) walloc_tilasto[l].live_bytes, (unsigned long) walloc_tilasto[l].peak_bytes);
+    printf("all       %8s %8lu %13lu %13lu\n", "", (unsigned long) walloc_taulu_kpl, (unsigned long) walloc_elossa, (unsigned long) walloc_huippu);
+
+    SDL_UnlockMutex(walloc_lukko);
+}
+
 void wtoggle(int *what) {
     if (*what)
         *what = 0;
@@ -221,9 +435,29 @@ void calculate_difference(int x1, int y1, int x2, int y2, int *distance, int *an
     }
 }
 
+/*
+ * Square root rounded to nearest, for 0 <= number < 2^24. The floating
+ * point estimate is only used as a starting point and is corrected to
+ * the exact integer root, so the result does not depend on how the
+ * platform rounds. Returns 1 for 0 like squareroot() does.
+ */
+static int isqrt_rounded(int number) {
+    int result = (int) sqrt((double) number);
+
+    if (result * result > number)
+        result--;
+    else if ((result + 1) * (result + 1) <= number)
+        result++;
+
+    return result + (number - result * result >= result);
+}
+
 int squareroot(int number) {
     int l, old_result, new_result;
 
+    if (number >= 0 && number < SQUAREROOT_EXACT_LIMIT)
+        return isqrt_rounded(number);
+
     if (!(old_result = new_result = number >> 1))
         return 1;
 
@@ -27,9 +27,32 @@ void setwrandom(int seed);
 int wrandom(int limit);
 void wrandom_sanity_check(void);
 
-void *walloc(size_t size);
+/* Allocation tags for walloc() accounting */
+#define WALLOC_MUU 0
+#define WALLOC_BITMAP 1
+#define WALLOC_SAMPLE 2
+#define WALLOC_LEVEL 3
+#define WALLOC_FONT 4
+#define WALLOC_RECORD 5
+#define WALLOC_DATAFILE 6
+#define WALLOC_TAGS 7
+
+struct walloc_stat {
+    unsigned long allocations;
+    unsigned long live;
+    size_t live_bytes;
+    size_t peak_bytes;
+};
+
+void *walloc(size_t size, int tag = WALLOC_MUU);
 void wfree(void *);
 
+void walloc_start_tracking(void);
+void walloc_retag(void *ptr, int tag);
+void walloc_stats(int tag, walloc_stat * stat);
+size_t walloc_live_bytes(void);
+void walloc_report(void);
+
 void wtoggle(int *);
 
 void init_trigs(void);
@@ -52,6 +52,13 @@ int flame_y[MAX_FLAMES];
 int flame_width[MAX_FLAMES];
 int flame_age[MAX_FLAMES];
 
+static char fobjects_moved[MAX_FLYING_OBJECTS];
+static char fobjects_fate[MAX_FLYING_OBJECTS];
+
+#define FOBJECT_STAYS   0
+#define FOBJECT_LEAVES  1       /* outside the level or hit the ground */
+#define FOBJECT_EXPIRES 2       /* animation over */
+
 /******************************************************************************/
 
 void start_flame(int x, int y, int width) {
@@ -94,20 +101,20 @@ void start_one_flame(int x, int y) {
     int l;
 
     for (l = 0; l < MAX_FLYING_OBJECTS; l++)
-        if (!fobjects[l].x)
+        if (!fobjects_x[l])
             break;
 
     if (l != MAX_FLYING_OBJECTS) {
-        fobjects[l].x = x << 8;
-        fobjects[l].y = y << 8;
-
-        fobjects[l].x_speed = 0;
-        fobjects[l].y_speed = 0;
-        fobjects[l].hit_plane = 0;
-        fobjects[l].width = 7;
-        fobjects[l].height = 14;
-        fobjects[l].type = FOBJECTS_FLAME;
-        fobjects[l].phase = 0;
+        fobjects_x[l] = x << 8;
+        fobjects_y[l] = y << 8;
+
+        fobjects_x_speed[l] = 0;
+        fobjects_y_speed[l] = 0;
+        fobjects_hit_plane[l] = 0;
+        fobjects_width[l] = 7;
+        fobjects_height[l] = 14;
+        fobjects_type[l] = FOBJECTS_FLAME;
+        fobjects_phase[l] = 0;
     }
 
 }
@@ -124,10 +131,10 @@ void do_shots(void) {
             shots_flying_x[l] += shots_flying_x_speed[l] >> 9;
             shots_flying_y[l] -= shots_flying_y_speed[l] >> 9;
 
-            if ((shots_flying_x[l] < 0) || ((shots_flying_x[l] >> 8) >= NUMBER_OF_SCENES * 160) || shots_flying_y[l] < 0 || (shots_flying_y[l] >> 8) >= 200)
+            if ((shots_flying_x[l] < 0) || ((shots_flying_x[l] >> 8) >= level_width) || shots_flying_y[l] < 0 || (shots_flying_y[l] >> 8) >= 200)
                 shots_flying_x[l] = 0;
             else {
-                kohta = level_bitmap[(shots_flying_x[l] >> 8) + (shots_flying_y[l] >> 8) * 2400];
+                kohta = level_pixel(shots_flying_x[l] >> 8, shots_flying_y[l] >> 8);
                 if (kohta < 112 || kohta > 119) {
                     if (kohta >= 224 && kohta <= 231)
                         start_gun_wave(shots_flying_x[l] >> 8);
@@ -242,42 +249,150 @@ void start_shot(int player) {
     }
 }
 
-void do_fobjects(void) {
-    int l, l2;
+/*
+ * Gravity and animation of object l for one frame. Returns
+ * FOBJECT_EXPIRES once the animation has run out.
+ */
+static inline int age_fobject(int l) {
+    switch (fobjects_type[l]) {
+    case FOBJECTS_SMOKE:
+        fobjects_phase[l]++;
+        if (fobjects_phase[l] == SMOKE_FRAMES)
+            return FOBJECT_EXPIRES;
+        break;
+
+    case FOBJECTS_SSMOKE:
+        fobjects_phase[l]++;
+        if (fobjects_phase[l] == 17)
+            return FOBJECT_EXPIRES;
+        break;
+
+    case FOBJECTS_RIFLE:
+        fobjects_phase[l]++;
+        if (fobjects_phase[l] == 12)
+            fobjects_phase[l] = 0;
+        fobjects_y_speed[l] -= FOBJECTS_GRAVITY;
+        break;
+
+    case FOBJECTS_WAVE1:
+        fobjects_phase[l]++;
+        if (fobjects_phase[l] == WAVE1_FRAMES)
+            return FOBJECT_EXPIRES;
+        break;
+
+    case FOBJECTS_WAVE2:
+        fobjects_phase[l]++;
+        if (fobjects_phase[l] == WAVE2_FRAMES)
+            return FOBJECT_EXPIRES;
+        break;
+
+    case FOBJECTS_ITEXPLOSION:
+        fobjects_phase[l]++;
+        if (fobjects_phase[l] == ITEXPLOSION_FRAMES)
+            return FOBJECT_EXPIRES;
+        break;
+
+    case FOBJECTS_PARTS:
+        fobjects_y_speed[l] -= FOBJECTS_GRAVITY;
+        break;
+
+    case FOBJECTS_EXPLOX:
+        fobjects_phase[l]++;
+        if (fobjects_phase[l] == EXPLOX_FRAMES)
+            return FOBJECT_EXPIRES;
+        break;
+
+    case FOBJECTS_FLAME:
+        fobjects_phase[l]++;
+        if (fobjects_phase[l] == NUMBER_OF_FLAMES)
+            return FOBJECT_EXPIRES;
+        break;
+    }
+
+    return FOBJECT_STAYS;
+}
+
+/*
+ * One step of object l: move, check the level bounds and the sky
+ * colours under the object, and advance gravity and animation. The
+ * result is left in fobjects_fate[l] and only acted on by
+ * do_fobjects(), so that slots become free in the same order as
+ * before.
+ */
+static inline void step_fobject(int l) {
+    int x, y, pikseli;
+
+    fobjects_x[l] += fobjects_x_speed[l] >> 8;
+    fobjects_y[l] -= fobjects_y_speed[l] >> 8;
+    x = fobjects_x[l];
+    y = fobjects_y[l];
+
+    if ((y < 0) || (x < 0) || ((x >> 8) >= level_width) || (y >> 8) >= 200) {
+        fobjects_fate[l] = FOBJECT_LEAVES;
+        return;
+    }
+
+    pikseli = level_pixel(x >> 8, y >> 8);
+    if (pikseli < 112 || pikseli > 119) {
+        fobjects_fate[l] = FOBJECT_LEAVES;
+        return;
+    }
+
+    fobjects_fate[l] = age_fobject(l);
+}
+
+/*
+ * Step every live object in one pass over the arrays. Objects spawned
+ * later in the frame (smoke from flames, parts from planes hit by
+ * parts) are not marked in fobjects_moved and get their step when
+ * do_fobjects() reaches them, exactly as before. An object that would
+ * land on x == 0 is left for do_fobjects() too, so that its slot does
+ * not look free to start_*() in the meantime.
+ */
+static void move_fobjects(void) {
+    int l;
 
     for (l = 0; l < MAX_FLYING_OBJECTS; l++) {
-        if (fobjects[l].x) {
+        fobjects_moved[l] = (fobjects_x[l] != 0) & (fobjects_x[l] + (fobjects_x_speed[l] >> 8) != 0);
+        if (fobjects_moved[l])
+            step_fobject(l);
+    }
+}
 
-            fobjects[l].x += fobjects[l].x_speed >> 8;
-            fobjects[l].y -= fobjects[l].y_speed >> 8;
+void do_fobjects(void) {
+    int l, l2, osui;
 
-            if ((fobjects[l].y < 0) || (fobjects[l].x < 0) || ((fobjects[l].x >> 8) >= NUMBER_OF_SCENES * 160) || (fobjects[l].y >> 8) >= 200) {
-                fobjects[l].x = 0;
-                continue;
-            }
+    move_fobjects();
 
-            if ((level_bitmap[(fobjects[l].x >> 8) + (fobjects[l].y >> 8) * 2400]) < 112
-                || ((level_bitmap[(fobjects[l].x >> 8) + (fobjects[l].y >> 8) * 2400])) > 119) {
-                fobjects[l].x = 0;
+    for (l = 0; l < MAX_FLYING_OBJECTS; l++) {
+        if (fobjects_moved[l] || fobjects_x[l]) {
+
+            if (!fobjects_moved[l])
+                step_fobject(l);
+
+            if (fobjects_fate[l] == FOBJECT_LEAVES) {
+                fobjects_x[l] = 0;
                 continue;
             }
 
-            if (fobjects[l].hit_plane && part_collision_detect)
+            osui = 0;
+            if (fobjects_hit_plane[l] && part_collision_detect)
                 for (l2 = 0; l2 < 16; l2++) {
                     if (plane_present[l2]) {
-                        if (((player_x[l2] + 2304) > fobjects[l].x) &&
-                            ((player_x[l2] - 2304) < fobjects[l].x) && ((player_y[l2] + 2304) > fobjects[l].y) && ((player_y[l2] - 2304) < fobjects[l].y))
+                        if (((player_x[l2] + 2304) > fobjects_x[l]) &&
+                            ((player_x[l2] - 2304) < fobjects_x[l]) && ((player_y[l2] + 2304) > fobjects_y[l]) && ((player_y[l2] - 2304) < fobjects_y[l]))
                             if (plane_p[l2][(player_angle[l2] >> 8) / 6][player_rolling[l2]][player_upsidedown[l2]]
-                                [(fobjects[l].x >> 8) - (player_x_8[l2]) + 10 + ((fobjects[l].y >> 8) - (player_y_8[l2]) + 10) * 20] != 255) {
-                                fobjects[l].x = 0;
+                                [(fobjects_x[l] >> 8) - (player_x_8[l2]) + 10 + ((fobjects_y[l] >> 8) - (player_y_8[l2]) + 10) * 20] != 255) {
+                                fobjects_x[l] = 0;
+                                osui = 1;
                                 player_endurance[l2] -= wrandom(FOBJECTS_DAMAGE);
                                 if (player_endurance[l2] < 1) {
-                                    if ((fobjects[l].owner != -1) && (!player_spinning[l2])) {
-                                        player_shots_down[fobjects[l].owner][l2]++;
-                                        if (player_sides[fobjects[l].owner] != player_sides[l2])
-                                            player_points[fobjects[l].owner]++;
+                                    if ((fobjects_owner[l] != -1) && (!player_spinning[l2])) {
+                                        player_shots_down[fobjects_owner[l]][l2]++;
+                                        if (player_sides[fobjects_owner[l]] != player_sides[l2])
+                                            player_points[fobjects_owner[l]]++;
                                         else
-                                            player_points[fobjects[l].owner]--;
+                                            player_points[fobjects_owner[l]]--;
                                     }
 
                                     if (wrandom(2) == 1 && (!player_on_airfield[l2]))
@@ -293,70 +408,19 @@ void do_fobjects(void) {
                     }
                 }
 
+            /*
+             * start_parts() may have put a new object in this slot.
+             * It is aged right away, as it always has been.
+             */
+            if (osui)
+                fobjects_fate[l] = age_fobject(l);
 
+            if (fobjects_fate[l] == FOBJECT_EXPIRES)
+                fobjects_x[l] = 0;
 
-            switch (fobjects[l].type) {
-            case FOBJECTS_SMOKE:
-                fobjects[l].phase++;
-                if (fobjects[l].phase == SMOKE_FRAMES)
-                    fobjects[l].x = 0;
-                break;
-
-            case FOBJECTS_SSMOKE:
-                fobjects[l].phase++;
-                if (fobjects[l].phase == 17)
-                    fobjects[l].x = 0;
-                break;
-
-
-            case FOBJECTS_RIFLE:
-                fobjects[l].phase++;
-                if (fobjects[l].phase == 12)
-                    fobjects[l].phase = 0;
-                fobjects[l].y_speed -= FOBJECTS_GRAVITY;
-                break;
-
-
-            case FOBJECTS_WAVE1:
-                fobjects[l].phase++;
-                if (fobjects[l].phase == WAVE1_FRAMES)
-                    fobjects[l].x = 0;
-                break;
-
-            case FOBJECTS_WAVE2:
-                fobjects[l].phase++;
-                if (fobjects[l].phase == WAVE2_FRAMES)
-                    fobjects[l].x = 0;
-                break;
-
-
-            case FOBJECTS_ITEXPLOSION:
-                fobjects[l].phase++;
-                if (fobjects[l].phase == ITEXPLOSION_FRAMES)
-                    fobjects[l].x = 0;
-                break;
-
-
-            case FOBJECTS_PARTS:
-                fobjects[l].y_speed -= FOBJECTS_GRAVITY;
-                break;
-
-            case FOBJECTS_EXPLOX:
-                fobjects[l].phase++;
-                if (fobjects[l].phase == EXPLOX_FRAMES)
-                    fobjects[l].x = 0;
-                break;
-
-            case FOBJECTS_FLAME:
-                fobjects[l].phase++;
-                if (fobjects[l].phase == NUMBER_OF_FLAMES)
-                    fobjects[l].x = 0;
-
-                if (config.structure_smoke)
-                    if (fobjects[l].phase & 3)
-                        start_ssmoke(fobjects[l].x, fobjects[l].y - 256);
-                break;
-            }
+            if (fobjects_type[l] == FOBJECTS_FLAME && config.structure_smoke)
+                if (fobjects_phase[l] & 3)
+                    start_ssmoke(fobjects_x[l], fobjects_y[l] - 256);
         }
     }
 }
@@ -366,19 +430,19 @@ void start_wave(int x) {
     int l;
 
     for (l = 0; l < MAX_FLYING_OBJECTS; l++)
-        if (!fobjects[l].x)
+        if (!fobjects_x[l])
             break;
 
     if (l != MAX_FLYING_OBJECTS) {
-        fobjects[l].x = (x) << 8;
-        fobjects[l].y = (terrain_level[x] - 11) << 8;
-        fobjects[l].x_speed = 0;
-        fobjects[l].y_speed = 0;
-        fobjects[l].hit_plane = 0;
-        fobjects[l].width = 23;
-        fobjects[l].height = 23;
-        fobjects[l].type = FOBJECTS_WAVE1;
-        fobjects[l].phase = 0;
+        fobjects_x[l] = (x) << 8;
+        fobjects_y[l] = (terrain_level[x] - 11) << 8;
+        fobjects_x_speed[l] = 0;
+        fobjects_y_speed[l] = 0;
+        fobjects_hit_plane[l] = 0;
+        fobjects_width[l] = 23;
+        fobjects_height[l] = 23;
+        fobjects_type[l] = FOBJECTS_WAVE1;
+        fobjects_phase[l] = 0;
     }
 
 }
@@ -387,19 +451,19 @@ void start_gun_wave(int x) {
     int l;
 
     for (l = 0; l < MAX_FLYING_OBJECTS; l++)
-        if (!fobjects[l].x)
+        if (!fobjects_x[l])
             break;
 
     if (l != MAX_FLYING_OBJECTS) {
-        fobjects[l].x = (x) << 8;
-        fobjects[l].y = (terrain_level[x] - 2) << 8;
-        fobjects[l].x_speed = 0;
-        fobjects[l].y_speed = 0;
-        fobjects[l].hit_plane = 0;
-        fobjects[l].width = 3;
-        fobjects[l].height = 5;
-        fobjects[l].type = FOBJECTS_WAVE2;
-        fobjects[l].phase = 0;
+        fobjects_x[l] = (x) << 8;
+        fobjects_y[l] = (terrain_level[x] - 2) << 8;
+        fobjects_x_speed[l] = 0;
+        fobjects_y_speed[l] = 0;
+        fobjects_hit_plane[l] = 0;
+        fobjects_width[l] = 3;
+        fobjects_height[l] = 5;
+        fobjects_type[l] = FOBJECTS_WAVE2;
+        fobjects_phase[l] = 0;
     }
 
 }
@@ -409,20 +473,20 @@ void start_smoke(int player) {
     int l;
 
     for (l = 0; l < MAX_FLYING_OBJECTS; l++)
-        if (!fobjects[l].x)
+        if (!fobjects_x[l])
             break;
 
     if (l != MAX_FLYING_OBJECTS) {
-        fobjects[l].x = player_x[player] - 12 * cosinit[player_angle[player] >> 8];
-        fobjects[l].y = player_y[player] + 12 * sinit[player_angle[player] >> 8];
-
-        fobjects[l].x_speed = 0;
-        fobjects[l].y_speed = 0;
-        fobjects[l].hit_plane = 0;
-        fobjects[l].width = 20;
-        fobjects[l].height = 20;
-        fobjects[l].type = FOBJECTS_SMOKE;
-        fobjects[l].phase = 0;
+        fobjects_x[l] = player_x[player] - 12 * cosinit[player_angle[player] >> 8];
+        fobjects_y[l] = player_y[player] + 12 * sinit[player_angle[player] >> 8];
+
+        fobjects_x_speed[l] = 0;
+        fobjects_y_speed[l] = 0;
+        fobjects_hit_plane[l] = 0;
+        fobjects_width[l] = 20;
+        fobjects_height[l] = 20;
+        fobjects_type[l] = FOBJECTS_SMOKE;
+        fobjects_phase[l] = 0;
     }
 
 }
@@ -431,21 +495,21 @@ void start_ssmoke(int x, int y) {
     int l;
 
     for (l = 0; l < MAX_FLYING_OBJECTS; l++)
-        if (!fobjects[l].x)
+        if (!fobjects_x[l])
             break;
 
     if (l != MAX_FLYING_OBJECTS) {
 
-        fobjects[l].x = x;
-        fobjects[l].y = y - 1024 + wrandom(2048);
+        fobjects_x[l] = x;
+        fobjects_y[l] = y - 1024 + wrandom(2048);
 
-        fobjects[l].x_speed = 0;
-        fobjects[l].y_speed = 256 * 256 * 3;
-        fobjects[l].hit_plane = 0;
-        fobjects[l].width = 9;
-        fobjects[l].height = 9;
-        fobjects[l].type = FOBJECTS_SSMOKE;
-        fobjects[l].phase = 0;
+        fobjects_x_speed[l] = 0;
+        fobjects_y_speed[l] = 256 * 256 * 3;
+        fobjects_hit_plane[l] = 0;
+        fobjects_width[l] = 9;
+        fobjects_height[l] = 9;
+        fobjects_type[l] = FOBJECTS_SSMOKE;
+        fobjects_phase[l] = 0;
     }
 
 }
@@ -462,21 +526,21 @@ void start_explox(int x, int y) {
 
 
         for (l = 0; l < MAX_FLYING_OBJECTS; l++)
-            if (!fobjects[l].x)
+            if (!fobjects_x[l])
                 break;
 
         if (l != MAX_FLYING_OBJECTS) {
-            fobjects[l].x = x + wrandom(EXPLOX_VARIETY) - (EXPLOX_VARIETY / 2);
-            fobjects[l].y = y + wrandom(EXPLOX_VARIETY) - (EXPLOX_VARIETY / 2);
-
-            fobjects[l].x_speed = 0;
-            fobjects[l].y_speed = 0;
-            fobjects[l].hit_plane = 0;
-            fobjects[l].width = 9;
-            fobjects[l].height = 9;
-            fobjects[l].type = FOBJECTS_EXPLOX;
-            fobjects[l].subtype = wrandom(4);
-            fobjects[l].phase = 0 - wrandom(EXPLOX_PHASE_DIFF);
+            fobjects_x[l] = x + wrandom(EXPLOX_VARIETY) - (EXPLOX_VARIETY / 2);
+            fobjects_y[l] = y + wrandom(EXPLOX_VARIETY) - (EXPLOX_VARIETY / 2);
+
+            fobjects_x_speed[l] = 0;
+            fobjects_y_speed[l] = 0;
+            fobjects_hit_plane[l] = 0;
+            fobjects_width[l] = 9;
+            fobjects_height[l] = 9;
+            fobjects_type[l] = FOBJECTS_EXPLOX;
+            fobjects_subtype[l] = wrandom(4);
+            fobjects_phase[l] = 0 - wrandom(EXPLOX_PHASE_DIFF);
 
         }
     }
@@ -511,20 +575,20 @@ void start_parts(int player) {
 
     for (l2 = 0; l2 < limit; l2++) {
         for (l = 0; l < MAX_FLYING_OBJECTS; l++)
-            if (!fobjects[l].x)
+            if (!fobjects_x[l])
                 break;
 
         if (l != MAX_FLYING_OBJECTS) {
-            fobjects[l].x = xxx;
-            fobjects[l].y = yyy;
-            fobjects[l].x_speed = xsss + wrandom(PARTS_SPEED) - (PARTS_SPEED >> 1);
-            fobjects[l].y_speed = (wrandom(PARTS_SPEED) - (PARTS_SPEED >> 1));
-            fobjects[l].hit_plane = 1;
-            fobjects[l].width = 10;
-            fobjects[l].height = 10;
-            fobjects[l].type = FOBJECTS_PARTS;
-            fobjects[l].phase = wrandom(NUMBER_OF_BITES);
-            fobjects[l].owner = -1;
+            fobjects_x[l] = xxx;
+            fobjects_y[l] = yyy;
+            fobjects_x_speed[l] = xsss + wrandom(PARTS_SPEED) - (PARTS_SPEED >> 1);
+            fobjects_y_speed[l] = (wrandom(PARTS_SPEED) - (PARTS_SPEED >> 1));
+            fobjects_hit_plane[l] = 1;
+            fobjects_width[l] = 10;
+            fobjects_height[l] = 10;
+            fobjects_type[l] = FOBJECTS_PARTS;
+            fobjects_phase[l] = wrandom(NUMBER_OF_BITES);
+            fobjects_owner[l] = -1;
         }
     }
 }
@@ -533,20 +597,20 @@ void start_rifle(int x, int y) {
     int l;
 
     for (l = 0; l < MAX_FLYING_OBJECTS; l++)
-        if (!fobjects[l].x)
+        if (!fobjects_x[l])
             break;
 
     if (l != MAX_FLYING_OBJECTS) {
-        fobjects[l].x = x << 8;
-        fobjects[l].y = y << 8;
-        fobjects[l].x_speed = 256 * 128 * 5 - wrandom(2560 * 128);
-        fobjects[l].y_speed = wrandom(256 * 5 * 128);
-        fobjects[l].hit_plane = 0;
-        fobjects[l].width = 8;
-        fobjects[l].height = 8;
-        fobjects[l].type = FOBJECTS_RIFLE;
-        fobjects[l].phase = 0;
-        fobjects[l].owner = -1;
+        fobjects_x[l] = x << 8;
+        fobjects_y[l] = y << 8;
+        fobjects_x_speed[l] = 256 * 128 * 5 - wrandom(2560 * 128);
+        fobjects_y_speed[l] = wrandom(256 * 5 * 128);
+        fobjects_hit_plane[l] = 0;
+        fobjects_width[l] = 8;
+        fobjects_height[l] = 8;
+        fobjects_type[l] = FOBJECTS_RIFLE;
+        fobjects_phase[l] = 0;
+        fobjects_owner[l] = -1;
     }
 
 }
@@ -625,13 +689,13 @@ void do_bombs(void) {
             bomb_angle[l] += 92160;
 
 
-        if ((bomb_x[l] < 0) || (bomb_x[l] >> 8) >= 2400 || (bomb_y[l] >> 8) > 199) {
+        if ((bomb_x[l] < 0) || (bomb_x[l] >> 8) >= level_width || (bomb_y[l] >> 8) > 199) {
             bomb_x[l] = 0;
             continue;
         }
 
         if (bomb_y[l] >= 0)
-            if ((level_bitmap[(bomb_x[l] >> 8) + (bomb_y[l] >> 8) * 2400]) < 112 || ((level_bitmap[(bomb_x[l] >> 8) + (bomb_y[l] >> 8) * 2400])) > 119
+            if ((level_pixel(bomb_x[l] >> 8, bomb_y[l] >> 8)) < 112 || ((level_pixel(bomb_x[l] >> 8, bomb_y[l] >> 8))) > 119
                 || ((bomb_y[l] >> 8) >= 200)) {
                 start_bomb_explo(l);
 
@@ -712,8 +776,8 @@ void start_bomb_explo(int bb, int hitted) {
     limit += MIN_BOMB_PARTS;
 
 
-    if ((level_bitmap[(bomb_x[bb] >> 8) + (bomb_y[bb] >> 8) * 2400] >= 224)
-        && (level_bitmap[(bomb_x[bb] >> 8) + (bomb_y[bb] >> 8) * 2400] <= 231)) {
+    if ((level_pixel(bomb_x[bb] >> 8, bomb_y[bb] >> 8) >= 224)
+        && (level_pixel(bomb_x[bb] >> 8, bomb_y[bb] >> 8) <= 231)) {
         start_wave(bomb_x[bb] >> 8);
         if (config.splash && config.sound_on && config.sfx_on)
             play_2d_sample(sample_splash[wrandom(3)], player_x_8[solo_country], bomb_x[bb] >> 8);
@@ -856,20 +920,20 @@ void start_bomb_explo(int bb, int hitted) {
     if (palasia)
         for (l2 = 0; l2 < limit; l2++) {
             for (l = 0; l < MAX_FLYING_OBJECTS; l++)
-                if (!fobjects[l].x)
+                if (!fobjects_x[l])
                     break;
 
             if (l != MAX_FLYING_OBJECTS) {
-                fobjects[l].x = bomb_x[bb];
-                fobjects[l].y = bomb_y[bb];
-                fobjects[l].x_speed = wrandom(PARTS_SPEED) - PARTS_SPEED / 2;
-                fobjects[l].y_speed = (wrandom(PARTS_SPEED) - PARTS_SPEED / 2);
-                fobjects[l].hit_plane = 1;
-                fobjects[l].width = 10;
-                fobjects[l].height = 10;
-                fobjects[l].type = FOBJECTS_PARTS;
-                fobjects[l].phase = wrandom(NUMBER_OF_BITES);
-                fobjects[l].owner = bomb_owner[bb];
+                fobjects_x[l] = bomb_x[bb];
+                fobjects_y[l] = bomb_y[bb];
+                fobjects_x_speed[l] = wrandom(PARTS_SPEED) - PARTS_SPEED / 2;
+                fobjects_y_speed[l] = (wrandom(PARTS_SPEED) - PARTS_SPEED / 2);
+                fobjects_hit_plane[l] = 1;
+                fobjects_width[l] = 10;
+                fobjects_height[l] = 10;
+                fobjects_type[l] = FOBJECTS_PARTS;
+                fobjects_phase[l] = wrandom(NUMBER_OF_BITES);
+                fobjects_owner[l] = bomb_owner[bb];
             }
         }
 }
@@ -0,0 +1,213 @@
+/* 
+ * Triplane Classic - a side-scrolling dogfighting game.
+ * Copyright (C) 1996,1997,2009  Dodekaedron Software Creations Oy
+ * 
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * tjt@users.sourceforge.net
+ */
+
+/*
+ * Background loading of the next level. While the player is in the
+ * menus or looking at the aftermath, the level most likely to be
+ * played next is decoded on a worker thread: the scenery and every
+ * structure picture with its destroyed variant. load_level() then
+ * takes the decoded data if it is for the level being loaded.
+ *
+ * The datafile entries are looked up on the calling thread before
+ * the worker is started, so that packed entries are unpacked there
+ * and the worker only reads memory nobody else writes. If a thread
+ * cannot be created nothing is prefetched and load_level() does all
+ * the work as before.
+ */
+
+#include <SDL.h>
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+#include "io/dksfile.h"
+#include "util/arena.h"
+#include "world/prefetch.h"
+
+#define MAX_PREFETCH_BITMAPS (MAX_STRUCTURES * 2)
+
+struct prefetch_kuva {
+    char nimi[8];
+    Bitmap *kuva;
+};
+
+static char esilataus_nimi[80];
+static level_struct esilataus_leveldata;
+static char esilataus_maisema_nimi[8];
+static Bitmap *esilataus_maisema = NULL;
+static prefetch_kuva esilataus_kuvat[MAX_PREFETCH_BITMAPS];
+static int esilataus_kuvia = 0;
+
+static SDL_Thread *esilataus_saie = NULL;
+static int esilataus_valmis = 0;
+
+static int prefetch_thread(void *data) {
+    int l;
+
+    // The arena is not thread safe. load_level() joins this thread
+    // before it opens the arena, so the pictures come from walloc().
+    assert(!level_arena_is_open());
+
+    esilataus_maisema = new Bitmap(esilataus_maisema_nimi, 0);
+
+    for (l = 0; l < esilataus_kuvia; l++)
+        esilataus_kuvat[l].kuva = new Bitmap(esilataus_kuvat[l].nimi);
+
+    return 0;
+}
+
+static void prefetch_wait(void) {
+    if (esilataus_saie == NULL)
+        return;
+
+    SDL_WaitThread(esilataus_saie, NULL);
+    esilataus_saie = NULL;
+    esilataus_valmis = 1;
+}
+
+static void prefetch_add(const char *nimi) {
+    int l;
+
+    if (!nimi[0] || esilataus_kuvia == MAX_PREFETCH_BITMAPS)
+        return;
+
+    for (l = 0; l < esilataus_kuvia; l++)
+        if (!strcmp(esilataus_kuvat[l].nimi, nimi))
+            return;
+
+    if (dksentry(nimi, NULL) == NULL)
+        return;
+
+    strcpy(esilataus_kuvat[esilataus_kuvia].nimi, nimi);
+    esilataus_kuvat[esilataus_kuvia].kuva = NULL;
+    esilataus_kuvia++;
+}
+
+/*
+ * Start decoding level nimi in the background. Does nothing if that
+ * level is already being prefetched or the level is not in the
+ * datafile.
+ */
+void prefetch_level(const char *nimi) {
+    static int atexit_done = 0;
+    const uint8_t *data;
+    char kuva[8];
+    int koko, l, l2;
+
+    if ((esilataus_saie != NULL || esilataus_valmis) && !strcmp(esilataus_nimi, nimi))
+        return;
+
+    prefetch_release();
+
+    data = dksentry(nimi, &koko);
+    if (data == NULL || koko < (int) sizeof(level_struct))
+        return;
+
+    memcpy(&esilataus_leveldata, data, sizeof(level_struct));
+
+    strncpy(esilataus_maisema_nimi, esilataus_leveldata.pb_name, 7);
+    esilataus_maisema_nimi[7] = 0;
+    if (dksentry(esilataus_maisema_nimi, NULL) == NULL)
+        return;
+
+    for (l = 0; l < MAX_STRUCTURES; l++) {
+        if (!esilataus_leveldata.struct_x[l])
+            continue;
+
+        strncpy(kuva, esilataus_leveldata.pd_name[l], 7);
+        kuva[7] = 0;
+
+        if (!strncmp(kuva, "FLAGS", 5) || !strncmp(kuva, "INFAN", 5) || !strncmp(kuva, "INSTOP", 6) ||
+            !strncmp(kuva, "KKBASE", 6) || !strncmp(kuva, "ITGUN", 5))
+            continue;
+
+        prefetch_add(kuva);
+
+        for (l2 = 0; l2 < NUMBER_OF_STRUCT_NAMES; l2++)
+            if (!strcmp(struct_names[l2 * 2], kuva)) {
+                prefetch_add(struct_names[l2 * 2 + 1]);
+                break;
+            }
+    }
+
+    if (!atexit_done) {
+        // Join the worker before the allocation report and SDL_Quit()
+        atexit(prefetch_release);
+        atexit_done = 1;
+    }
+
+    strcpy(esilataus_nimi, nimi);
+    esilataus_saie = SDL_CreateThread(prefetch_thread, "prefetch", NULL);
+
+    if (esilataus_saie == NULL)
+        esilataus_kuvia = 0;
+}
+
+/*
+ * If level nimi has been prefetched, copy its (still little endian)
+ * leveldata to kohde, hand over the scenery and return 1.
+ */
+int prefetch_take_level(const char *nimi, level_struct * kohde, Bitmap ** maisema) {
+    prefetch_wait();
+
+    if (!esilataus_valmis || strcmp(esilataus_nimi, nimi) || esilataus_maisema == NULL)
+        return 0;
+
+    memcpy(kohde, &esilataus_leveldata, sizeof(level_struct));
+    *maisema = esilataus_maisema;
+    esilataus_maisema = NULL;
+
+    return 1;
+}
+
+/*
+ * Decoded picture nimi of the prefetched level, or NULL. The picture
+ * stays owned by the prefetcher.
+ */
+Bitmap *prefetch_bitmap(const char *nimi) {
+    int l;
+
+    if (!esilataus_valmis)
+        return NULL;
+
+    for (l = 0; l < esilataus_kuvia; l++)
+        if (!strcmp(esilataus_kuvat[l].nimi, nimi))
+            return esilataus_kuvat[l].kuva;
+
+    return NULL;
+}
+
+void prefetch_release(void) {
+    int l;
+
+    prefetch_wait();
+
+    if (esilataus_maisema != NULL) {
+        delete esilataus_maisema;
+        esilataus_maisema = NULL;
+    }
+
+    for (l = 0; l < esilataus_kuvia; l++)
+        if (esilataus_kuvat[l].kuva != NULL)
+            delete esilataus_kuvat[l].kuva;
+
+    esilataus_kuvia = 0;
+    esilataus_valmis = 0;
+    esilataus_nimi[0] = 0;
+}
@@ -0,0 +1,34 @@
+/* 
+ * Triplane Classic - a side-scrolling dogfighting game.
+ * Copyright (C) 1996,1997,2009  Dodekaedron Software Creations Oy
+ * 
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * tjt@users.sourceforge.net
+ */
+
+#ifndef PREFETCH_H
+#define PREFETCH_H
+
+/* Background loading of the next level */
+
+#include "gfx/bitmap.h"
+#include "triplane.h"
+
+extern void prefetch_level(const char *nimi);
+extern int prefetch_take_level(const char *nimi, level_struct * kohde, Bitmap ** maisema);
+extern Bitmap *prefetch_bitmap(const char *nimi);
+extern void prefetch_release(void);
+
+#endif
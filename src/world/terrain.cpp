@@ -127,8 +127,8 @@ void terrain_to_screen(void) {
             player_shown_y[l] = 45 + (player_y_speed[l] / 10000);
 
 
-            if (((player_x_8[l]) - player_shown_x[l] + 160) > NUMBER_OF_SCENES * 160)
-                player_shown_x[l] -= NUMBER_OF_SCENES * 160 - ((player_x_8[l]) - player_shown_x[l] + 160);
+            if (((player_x_8[l]) - player_shown_x[l] + 160) > level_width)
+                player_shown_x[l] -= level_width - ((player_x_8[l]) - player_shown_x[l] + 160);
 
             if (((player_y_8[l]) - player_shown_y[l] + 90) > 200)
                 player_shown_y[l] -= 200 - ((player_y_8[l]) - player_shown_y[l] + 90);
@@ -356,71 +356,71 @@ void terrain_to_screen(void) {
                 }
 
             for (l2 = 0; l2 < MAX_FLYING_OBJECTS; l2++) {
-                if (fobjects[l2].x) {
-                    switch (fobjects[l2].type) {
+                if (fobjects_x[l2]) {
+                    switch (fobjects_type[l2]) {
                     case FOBJECTS_SMOKE:
-                        smoke[fobjects[l2].phase]->blit((fobjects[l2].x >> 8) + player_shown_x[l] - (player_x_8[l]) - (fobjects[l2].width >> 1) + x_muutos[l],
-                                                        (fobjects[l2].y >> 8) + player_shown_y[l] - (player_y_8[l]) - (fobjects[l2].height >> 1) + y_muutos[l],
+                        smoke[fobjects_phase[l2]]->blit((fobjects_x[l2] >> 8) + player_shown_x[l] - (player_x_8[l]) - (fobjects_width[l2] >> 1) + x_muutos[l],
+                                                        (fobjects_y[l2] >> 8) + player_shown_y[l] - (player_y_8[l]) - (fobjects_height[l2] >> 1) + y_muutos[l],
                                                         x1_raja[l], y1_raja[l] + in_closing[l], x2_raja[l], y2_raja[l]);
                         break;
 
 
                     case FOBJECTS_SSMOKE:
-                        ssmoke[fobjects[l2].phase]->blit((fobjects[l2].x >> 8) + player_shown_x[l] - (player_x_8[l]) - (fobjects[l2].width >> 1) + x_muutos[l],
-                                                         (fobjects[l2].y >> 8) + player_shown_y[l] - (player_y_8[l]) - (fobjects[l2].height >> 1) + y_muutos[l],
+                        ssmoke[fobjects_phase[l2]]->blit((fobjects_x[l2] >> 8) + player_shown_x[l] - (player_x_8[l]) - (fobjects_width[l2] >> 1) + x_muutos[l],
+                                                         (fobjects_y[l2] >> 8) + player_shown_y[l] - (player_y_8[l]) - (fobjects_height[l2] >> 1) + y_muutos[l],
                                                          x1_raja[l], y1_raja[l] + in_closing[l], x2_raja[l], y2_raja[l]);
                         break;
 
 
 
                     case FOBJECTS_RIFLE:
-                        rifle[fobjects[l2].phase]->blit((fobjects[l2].x >> 8) + player_shown_x[l] - (player_x_8[l]) - (fobjects[l2].width >> 1) + x_muutos[l],
-                                                        (fobjects[l2].y >> 8) + player_shown_y[l] - (player_y_8[l]) - (fobjects[l2].height >> 1) + y_muutos[l],
+                        rifle[fobjects_phase[l2]]->blit((fobjects_x[l2] >> 8) + player_shown_x[l] - (player_x_8[l]) - (fobjects_width[l2] >> 1) + x_muutos[l],
+                                                        (fobjects_y[l2] >> 8) + player_shown_y[l] - (player_y_8[l]) - (fobjects_height[l2] >> 1) + y_muutos[l],
                                                         x1_raja[l], y1_raja[l] + in_closing[l], x2_raja[l], y2_raja[l]);
                         break;
 
 
                     case FOBJECTS_FLAME:
                         if (config.flames)
-                            flames[fobjects[l2].phase]->blit((fobjects[l2].x >> 8) + player_shown_x[l] - (player_x_8[l]) - (fobjects[l2].width >> 1) +
+                            flames[fobjects_phase[l2]]->blit((fobjects_x[l2] >> 8) + player_shown_x[l] - (player_x_8[l]) - (fobjects_width[l2] >> 1) +
                                                              x_muutos[l],
-                                                             (fobjects[l2].y >> 8) + player_shown_y[l] - (player_y_8[l]) - (fobjects[l2].height >> 1) +
+                                                             (fobjects_y[l2] >> 8) + player_shown_y[l] - (player_y_8[l]) - (fobjects_height[l2] >> 1) +
                                                              y_muutos[l], x1_raja[l], y1_raja[l] + in_closing[l], x2_raja[l], y2_raja[l]);
                         break;
 
 
                     case FOBJECTS_WAVE1:
-                        wave1[fobjects[l2].phase]->blit((fobjects[l2].x >> 8) + player_shown_x[l] - (player_x_8[l]) - (fobjects[l2].width >> 1) + x_muutos[l],
-                                                        (fobjects[l2].y >> 8) + player_shown_y[l] - (player_y_8[l]) - (fobjects[l2].height >> 1) + y_muutos[l],
+                        wave1[fobjects_phase[l2]]->blit((fobjects_x[l2] >> 8) + player_shown_x[l] - (player_x_8[l]) - (fobjects_width[l2] >> 1) + x_muutos[l],
+                                                        (fobjects_y[l2] >> 8) + player_shown_y[l] - (player_y_8[l]) - (fobjects_height[l2] >> 1) + y_muutos[l],
                                                         x1_raja[l], y1_raja[l] + in_closing[l], x2_raja[l], y2_raja[l]);
                         break;
 
                     case FOBJECTS_WAVE2:
-                        wave2[fobjects[l2].phase]->blit((fobjects[l2].x >> 8) + player_shown_x[l] - (player_x_8[l]) - (fobjects[l2].width >> 1) + x_muutos[l],
-                                                        (fobjects[l2].y >> 8) + player_shown_y[l] - (player_y_8[l]) - (fobjects[l2].height >> 1) + y_muutos[l],
+                        wave2[fobjects_phase[l2]]->blit((fobjects_x[l2] >> 8) + player_shown_x[l] - (player_x_8[l]) - (fobjects_width[l2] >> 1) + x_muutos[l],
+                                                        (fobjects_y[l2] >> 8) + player_shown_y[l] - (player_y_8[l]) - (fobjects_height[l2] >> 1) + y_muutos[l],
                                                         x1_raja[l], y1_raja[l] + in_closing[l], x2_raja[l], y2_raja[l]);
                         break;
 
                     case FOBJECTS_ITEXPLOSION:
-                        itexplosion[fobjects[l2].phase]->blit((fobjects[l2].x >> 8) + player_shown_x[l] - (player_x_8[l]) - (fobjects[l2].width >> 1) +
+                        itexplosion[fobjects_phase[l2]]->blit((fobjects_x[l2] >> 8) + player_shown_x[l] - (player_x_8[l]) - (fobjects_width[l2] >> 1) +
                                                               x_muutos[l],
-                                                              (fobjects[l2].y >> 8) + player_shown_y[l] - (player_y_8[l]) - (fobjects[l2].height >> 1) +
+                                                              (fobjects_y[l2] >> 8) + player_shown_y[l] - (player_y_8[l]) - (fobjects_height[l2] >> 1) +
                                                               y_muutos[l], x1_raja[l], y1_raja[l] + in_closing[l], x2_raja[l], y2_raja[l]);
                         break;
 
                     case FOBJECTS_EXPLOX:
-                        if (fobjects[l2].phase < 0)
+                        if (fobjects_phase[l2] < 0)
                             break;
-                        explox[fobjects[l2].subtype][fobjects[l2].phase]->blit((fobjects[l2].x >> 8) + player_shown_x[l] - (player_x_8[l]) -
-                                                                               (fobjects[l2].width >> 1) + x_muutos[l],
-                                                                               (fobjects[l2].y >> 8) + player_shown_y[l] - (player_y_8[l]) -
-                                                                               (fobjects[l2].height >> 1) + y_muutos[l], x1_raja[l], y1_raja[l] + in_closing[l],
+                        explox[fobjects_subtype[l2]][fobjects_phase[l2]]->blit((fobjects_x[l2] >> 8) + player_shown_x[l] - (player_x_8[l]) -
+                                                                               (fobjects_width[l2] >> 1) + x_muutos[l],
+                                                                               (fobjects_y[l2] >> 8) + player_shown_y[l] - (player_y_8[l]) -
+                                                                               (fobjects_height[l2] >> 1) + y_muutos[l], x1_raja[l], y1_raja[l] + in_closing[l],
                                                                                x2_raja[l], y2_raja[l]);
                         break;
 
                     case FOBJECTS_PARTS:
-                        bites[fobjects[l2].phase]->blit((fobjects[l2].x >> 8) + player_shown_x[l] - (player_x_8[l]) - (fobjects[l2].width >> 1) + x_muutos[l],
-                                                        (fobjects[l2].y >> 8) + player_shown_y[l] - (player_y_8[l]) - (fobjects[l2].height >> 1) + y_muutos[l],
+                        bites[fobjects_phase[l2]]->blit((fobjects_x[l2] >> 8) + player_shown_x[l] - (player_x_8[l]) - (fobjects_width[l2] >> 1) + x_muutos[l],
+                                                        (fobjects_y[l2] >> 8) + player_shown_y[l] - (player_y_8[l]) - (fobjects_height[l2] >> 1) + y_muutos[l],
                                                         x1_raja[l], y1_raja[l] + in_closing[l], x2_raja[l], y2_raja[l]);
                         break;
 
@@ -568,8 +568,8 @@ void solo_terrain_to_screen(void) {
     player_shown_x[l] = 160;
     player_shown_y[l] = player_y[l] >> 8;
 
-    if (((player_x_8[l]) - player_shown_x[l] + 320) > NUMBER_OF_SCENES * 160)
-        player_shown_x[l] -= NUMBER_OF_SCENES * 160 - ((player_x_8[l]) - player_shown_x[l] + 320);
+    if (((player_x_8[l]) - player_shown_x[l] + 320) > level_width)
+        player_shown_x[l] -= level_width - ((player_x_8[l]) - player_shown_x[l] + 320);
 
     if (((player_x_8[l]) - player_shown_x[l]) < 0)
         player_shown_x[l] += ((player_x_8[l]) - player_shown_x[l]);
@@ -823,57 +823,57 @@ void solo_terrain_to_screen(void) {
         }
 
     for (l2 = 0; l2 < MAX_FLYING_OBJECTS; l2++) {
-        if (fobjects[l2].x) {
-            switch (fobjects[l2].type) {
+        if (fobjects_x[l2]) {
+            switch (fobjects_type[l2]) {
             case FOBJECTS_SMOKE:
-                smoke[fobjects[l2].phase]->blit((fobjects[l2].x >> 8) + player_shown_x[l] - (player_x_8[l]) - (fobjects[l2].width >> 1),
-                                                (fobjects[l2].y >> 8) - (fobjects[l2].height >> 1));
+                smoke[fobjects_phase[l2]]->blit((fobjects_x[l2] >> 8) + player_shown_x[l] - (player_x_8[l]) - (fobjects_width[l2] >> 1),
+                                                (fobjects_y[l2] >> 8) - (fobjects_height[l2] >> 1));
                 break;
 
             case FOBJECTS_SSMOKE:
-                ssmoke[fobjects[l2].phase]->blit((fobjects[l2].x >> 8) + player_shown_x[l] - (player_x_8[l]) - (fobjects[l2].width >> 1),
-                                                 (fobjects[l2].y >> 8) - (fobjects[l2].height >> 1));
+                ssmoke[fobjects_phase[l2]]->blit((fobjects_x[l2] >> 8) + player_shown_x[l] - (player_x_8[l]) - (fobjects_width[l2] >> 1),
+                                                 (fobjects_y[l2] >> 8) - (fobjects_height[l2] >> 1));
                 break;
 
 
             case FOBJECTS_RIFLE:
-                rifle[fobjects[l2].phase]->blit((fobjects[l2].x >> 8) + player_shown_x[l] - (player_x_8[l]) - (fobjects[l2].width >> 1),
-                                                (fobjects[l2].y >> 8) - (fobjects[l2].height >> 1));
+                rifle[fobjects_phase[l2]]->blit((fobjects_x[l2] >> 8) + player_shown_x[l] - (player_x_8[l]) - (fobjects_width[l2] >> 1),
+                                                (fobjects_y[l2] >> 8) - (fobjects_height[l2] >> 1));
                 break;
 
 
             case FOBJECTS_FLAME:
                 if (config.flames)
-                    flames[fobjects[l2].phase]->blit((fobjects[l2].x >> 8) + player_shown_x[l] - (player_x_8[l]) - (fobjects[l2].width >> 1),
-                                                     (fobjects[l2].y >> 8) - (fobjects[l2].height >> 1));
+                    flames[fobjects_phase[l2]]->blit((fobjects_x[l2] >> 8) + player_shown_x[l] - (player_x_8[l]) - (fobjects_width[l2] >> 1),
+                                                     (fobjects_y[l2] >> 8) - (fobjects_height[l2] >> 1));
                 break;
 
             case FOBJECTS_WAVE1:
-                wave1[fobjects[l2].phase]->blit((fobjects[l2].x >> 8) + player_shown_x[l] - (player_x_8[l]) - (fobjects[l2].width >> 1),
-                                                (fobjects[l2].y >> 8) - (fobjects[l2].height >> 1));
+                wave1[fobjects_phase[l2]]->blit((fobjects_x[l2] >> 8) + player_shown_x[l] - (player_x_8[l]) - (fobjects_width[l2] >> 1),
+                                                (fobjects_y[l2] >> 8) - (fobjects_height[l2] >> 1));
                 break;
 
             case FOBJECTS_WAVE2:
-                wave2[fobjects[l2].phase]->blit((fobjects[l2].x >> 8) + player_shown_x[l] - (player_x_8[l]) - (fobjects[l2].width >> 1),
-                                                (fobjects[l2].y >> 8) - (fobjects[l2].height >> 1));
+                wave2[fobjects_phase[l2]]->blit((fobjects_x[l2] >> 8) + player_shown_x[l] - (player_x_8[l]) - (fobjects_width[l2] >> 1),
+                                                (fobjects_y[l2] >> 8) - (fobjects_height[l2] >> 1));
                 break;
 
 
             case FOBJECTS_ITEXPLOSION:
-                itexplosion[fobjects[l2].phase]->blit((fobjects[l2].x >> 8) + player_shown_x[l] - (player_x_8[l]) - (fobjects[l2].width >> 1),
-                                                      (fobjects[l2].y >> 8) - (fobjects[l2].height >> 1));
+                itexplosion[fobjects_phase[l2]]->blit((fobjects_x[l2] >> 8) + player_shown_x[l] - (player_x_8[l]) - (fobjects_width[l2] >> 1),
+                                                      (fobjects_y[l2] >> 8) - (fobjects_height[l2] >> 1));
                 break;
 
             case FOBJECTS_EXPLOX:
-                if (fobjects[l2].phase < 0)
+                if (fobjects_phase[l2] < 0)
                     break;
-                explox[fobjects[l2].subtype][fobjects[l2].phase]->blit((fobjects[l2].x >> 8) + player_shown_x[l] - (player_x_8[l]) - (fobjects[l2].width >> 1),
-                                                                       (fobjects[l2].y >> 8) - (fobjects[l2].height >> 1));
+                explox[fobjects_subtype[l2]][fobjects_phase[l2]]->blit((fobjects_x[l2] >> 8) + player_shown_x[l] - (player_x_8[l]) - (fobjects_width[l2] >> 1),
+                                                                       (fobjects_y[l2] >> 8) - (fobjects_height[l2] >> 1));
                 break;
 
             case FOBJECTS_PARTS:
-                bites[fobjects[l2].phase]->blit((fobjects[l2].x >> 8) + player_shown_x[l] - (player_x_8[l]) - (fobjects[l2].width >> 1),
-                                                (fobjects[l2].y >> 8) - (fobjects[l2].height >> 1));
+                bites[fobjects_phase[l2]]->blit((fobjects_x[l2] >> 8) + player_shown_x[l] - (player_x_8[l]) - (fobjects_width[l2] >> 1),
+                                                (fobjects_y[l2] >> 8) - (fobjects_height[l2] >> 1));
                 break;
 
             }
@@ -1222,60 +1222,60 @@ void vesa_terrain_to_screen(void) {
     }
 
     for (l2 = 0; l2 < MAX_FLYING_OBJECTS; l2++) {
-        if (fobjects[l2].x) {
-            templevel = (((fobjects[l2].x >> 8) - (fobjects[l2].width >> 1)) / 800);
-            switch (fobjects[l2].type) {
+        if (fobjects_x[l2]) {
+            templevel = (((fobjects_x[l2] >> 8) - (fobjects_width[l2] >> 1)) / 800);
+            switch (fobjects_type[l2]) {
             case FOBJECTS_SMOKE:
-                smoke[fobjects[l2].phase]->blit(((fobjects[l2].x >> 8) - (fobjects[l2].width >> 1)) - templevel * 800,
-                                                ((fobjects[l2].y >> 8) - (fobjects[l2].height >> 1)) + templevel * 196 - 4, 0, templevel * 196, 799, 599);
+                smoke[fobjects_phase[l2]]->blit(((fobjects_x[l2] >> 8) - (fobjects_width[l2] >> 1)) - templevel * 800,
+                                                ((fobjects_y[l2] >> 8) - (fobjects_height[l2] >> 1)) + templevel * 196 - 4, 0, templevel * 196, 799, 599);
                 break;
 
             case FOBJECTS_SSMOKE:
-                ssmoke[fobjects[l2].phase]->blit(((fobjects[l2].x >> 8) - (fobjects[l2].width >> 1)) - templevel * 800,
-                                                 ((fobjects[l2].y >> 8) - (fobjects[l2].height >> 1)) + templevel * 196 - 4, 0, templevel * 196, 799, 599);
+                ssmoke[fobjects_phase[l2]]->blit(((fobjects_x[l2] >> 8) - (fobjects_width[l2] >> 1)) - templevel * 800,
+                                                 ((fobjects_y[l2] >> 8) - (fobjects_height[l2] >> 1)) + templevel * 196 - 4, 0, templevel * 196, 799, 599);
                 break;
 
 
             case FOBJECTS_RIFLE:
-                rifle[fobjects[l2].phase]->blit(((fobjects[l2].x >> 8) - (fobjects[l2].width >> 1)) - templevel * 800,
-                                                ((fobjects[l2].y >> 8) - (fobjects[l2].height >> 1)) + templevel * 196 - 4, 0, templevel * 196, 799, 599);
+                rifle[fobjects_phase[l2]]->blit(((fobjects_x[l2] >> 8) - (fobjects_width[l2] >> 1)) - templevel * 800,
+                                                ((fobjects_y[l2] >> 8) - (fobjects_height[l2] >> 1)) + templevel * 196 - 4, 0, templevel * 196, 799, 599);
                 break;
 
 
             case FOBJECTS_FLAME:
                 if (config.flames)
-                    flames[fobjects[l2].phase]->blit(((fobjects[l2].x >> 8) - (fobjects[l2].width >> 1)) - templevel * 800,
-                                                     ((fobjects[l2].y >> 8) - (fobjects[l2].height >> 1)) + templevel * 196 - 4, 0, templevel * 196, 799, 599);
+                    flames[fobjects_phase[l2]]->blit(((fobjects_x[l2] >> 8) - (fobjects_width[l2] >> 1)) - templevel * 800,
+                                                     ((fobjects_y[l2] >> 8) - (fobjects_height[l2] >> 1)) + templevel * 196 - 4, 0, templevel * 196, 799, 599);
                 break;
 
             case FOBJECTS_WAVE1:
-                wave1[fobjects[l2].phase]->blit(((fobjects[l2].x >> 8) - (fobjects[l2].width >> 1)) - templevel * 800,
-                                                ((fobjects[l2].y >> 8) - (fobjects[l2].height >> 1)) + templevel * 196 - 4, 0, templevel * 196, 799, 599);
+                wave1[fobjects_phase[l2]]->blit(((fobjects_x[l2] >> 8) - (fobjects_width[l2] >> 1)) - templevel * 800,
+                                                ((fobjects_y[l2] >> 8) - (fobjects_height[l2] >> 1)) + templevel * 196 - 4, 0, templevel * 196, 799, 599);
                 break;
 
             case FOBJECTS_WAVE2:
-                wave2[fobjects[l2].phase]->blit(((fobjects[l2].x >> 8) - (fobjects[l2].width >> 1)) - templevel * 800,
-                                                ((fobjects[l2].y >> 8) - (fobjects[l2].height >> 1)) + templevel * 196 - 4, 0, templevel * 196, 799, 599);
+                wave2[fobjects_phase[l2]]->blit(((fobjects_x[l2] >> 8) - (fobjects_width[l2] >> 1)) - templevel * 800,
+                                                ((fobjects_y[l2] >> 8) - (fobjects_height[l2] >> 1)) + templevel * 196 - 4, 0, templevel * 196, 799, 599);
                 break;
 
 
             case FOBJECTS_ITEXPLOSION:
-                itexplosion[fobjects[l2].phase]->blit(((fobjects[l2].x >> 8) - (fobjects[l2].width >> 1)) - templevel * 800,
-                                                      ((fobjects[l2].y >> 8) - (fobjects[l2].height >> 1)) + templevel * 196 - 4, 0, templevel * 196, 799, 599);
+                itexplosion[fobjects_phase[l2]]->blit(((fobjects_x[l2] >> 8) - (fobjects_width[l2] >> 1)) - templevel * 800,
+                                                      ((fobjects_y[l2] >> 8) - (fobjects_height[l2] >> 1)) + templevel * 196 - 4, 0, templevel * 196, 799, 599);
                 break;
 
 
             case FOBJECTS_EXPLOX:
-                if (fobjects[l2].phase < 0)
+                if (fobjects_phase[l2] < 0)
                     break;
-                explox[fobjects[l2].subtype][fobjects[l2].phase]->blit(((fobjects[l2].x >> 8) - (fobjects[l2].width >> 1)) - templevel * 800,
-                                                                       ((fobjects[l2].y >> 8) - (fobjects[l2].height >> 1)) + templevel * 196 - 4, 0,
+                explox[fobjects_subtype[l2]][fobjects_phase[l2]]->blit(((fobjects_x[l2] >> 8) - (fobjects_width[l2] >> 1)) - templevel * 800,
+                                                                       ((fobjects_y[l2] >> 8) - (fobjects_height[l2] >> 1)) + templevel * 196 - 4, 0,
                                                                        templevel * 196, 799, 599);
                 break;
 
             case FOBJECTS_PARTS:
-                bites[fobjects[l2].phase]->blit(((fobjects[l2].x >> 8) - (fobjects[l2].width >> 1)) - templevel * 800,
-                                                ((fobjects[l2].y >> 8) - (fobjects[l2].height >> 1)) + templevel * 196 - 4, 0, templevel * 196, 799, 599);
+                bites[fobjects_phase[l2]]->blit(((fobjects_x[l2] >> 8) - (fobjects_width[l2] >> 1)) - templevel * 800,
+                                                ((fobjects_y[l2] >> 8) - (fobjects_height[l2] >> 1)) + templevel * 196 - 4, 0, templevel * 196, 799, 599);
                 break;
 
             }
@@ -23,6 +23,7 @@
 #include "triplane.h"
 #include "fobjects.h"
 #include "util/wutil.h"
+#include "util/arena.h"
 #include "io/sound.h"
 #include "world/tripaudio.h"
 
@@ -48,11 +49,33 @@ int itgun_shot_age[MAX_ITGUN_SHOTS];
 
 int bomb_target;
 
+/*
+ * Infantry and structures are sorted into buckets by x so that a
+ * soldier only looks at its neighbours. Structures are bucketed once
+ * per level; infantry at the start of every do_infan(). Soldiers move
+ * at most INFAN_MAX_STEP pixels during do_infan(), so searches are
+ * widened by that much and then use the usual exact checks. The
+ * bucket tables are sized for the level in build_struct_buckets().
+ */
+#define INFAN_BUCKET_SHIFT 7
+#define INFAN_MAX_STEP 2
+
+static int (*infan_bucket)[MAX_INFANTRY] = NULL;
+static int *infan_bucket_count = NULL;
+static int (*struct_bucket)[MAX_STRUCTURES] = NULL;
+static int *struct_bucket_count = NULL;
+static int infan_buckets = 0;
+
+int ai_distance[16][16];
+int ai_angle[16][16];
+
 void do_infan(void);
 
 void infan_to_plane(int l);
 void infan_to_infan(int l);
 void infan_to_struct(int l);
+void build_struct_buckets(void);
+void build_infan_buckets(void);
 void infan_take_hits(int l);
 
 void do_kkbase(void);
@@ -60,6 +83,7 @@ void start_it_shot(int x, int y, int angle);
 void do_it_shots(void);
 void start_itgun_explosion(int number);
 
+void ai_plane_geometry(void);
 void do_ai(int number);
 void ai_turn_down(int number);
 void ai_turn_up(int number);
@@ -571,7 +595,7 @@ void ai_do_bombing(int number) {
         fake_x += fake_x_speed >> 9;
         fake_y -= fake_y_speed >> 9;
 
-        if ((fake_x < 0) | ((fake_x >> 8) >= 2400)) {
+        if ((fake_x < 0) | ((fake_x >> 8) >= level_width)) {
             return;
         }
 
@@ -606,19 +630,19 @@ void start_itgun_explosion(int number) {
     itgun_sound(itgun_shot_x[number] >> 8);
 
     for (l = 0; l < MAX_FLYING_OBJECTS; l++)
-        if (!fobjects[l].x)
+        if (!fobjects_x[l])
             break;
 
     if (l != MAX_FLYING_OBJECTS) {
-        fobjects[l].x = itgun_shot_x[number];
-        fobjects[l].y = itgun_shot_y[number];
-        fobjects[l].x_speed = 0;
-        fobjects[l].y_speed = 0;
-        fobjects[l].hit_plane = 0;
-        fobjects[l].width = 23;
-        fobjects[l].height = 14;
-        fobjects[l].type = FOBJECTS_ITEXPLOSION;
-        fobjects[l].phase = 0;
+        fobjects_x[l] = itgun_shot_x[number];
+        fobjects_y[l] = itgun_shot_y[number];
+        fobjects_x_speed[l] = 0;
+        fobjects_y_speed[l] = 0;
+        fobjects_hit_plane[l] = 0;
+        fobjects_width[l] = 23;
+        fobjects_height[l] = 14;
+        fobjects_type[l] = FOBJECTS_ITEXPLOSION;
+        fobjects_phase[l] = 0;
     }
 
     for (l = 0; l < 16; l++) {
@@ -670,10 +694,10 @@ void do_it_shots(void) {
             itgun_shot_y_speed[l] -= ITGUN_SHOT_GRAVITY;
             itgun_shot_x[l] += itgun_shot_x_speed[l] >> 9;
             itgun_shot_y[l] -= itgun_shot_y_speed[l] >> 9;
-            if ((itgun_shot_x[l] < 0) || ((itgun_shot_x[l] >> 8) >= NUMBER_OF_SCENES * 160) || (itgun_shot_y[l] >> 8) >= 200 || itgun_shot_y[l] < 0)
+            if ((itgun_shot_x[l] < 0) || ((itgun_shot_x[l] >> 8) >= level_width) || (itgun_shot_y[l] >> 8) >= 200 || itgun_shot_y[l] < 0)
                 itgun_shot_x[l] = 0;
-            else if ((level_bitmap[(itgun_shot_x[l] >> 8) + (itgun_shot_y[l] >> 8) * 2400]) < 112
-                     || ((level_bitmap[(itgun_shot_x[l] >> 8) + (itgun_shot_y[l] >> 8) * 2400])) > 119)
+            else if ((level_pixel(itgun_shot_x[l] >> 8, itgun_shot_y[l] >> 8)) < 112
+                     || ((level_pixel(itgun_shot_x[l] >> 8, itgun_shot_y[l] >> 8))) > 119)
                 itgun_shot_x[l] = 0;
 
             if (!(itgun_shot_age[l]--))
@@ -694,6 +718,53 @@ void do_it_shots(void) {
     }
 }
 
+static int infan_bucket_of(int x) {
+    if (x < 0)
+        return 0;
+
+    if (x >= level_width)
+        return infan_buckets - 1;
+
+    return x >> INFAN_BUCKET_SHIFT;
+}
+
+void build_struct_buckets(void) {
+    int l, b;
+
+    // Called from load_level(), the tables go with the level arena
+    infan_buckets = (level_width >> INFAN_BUCKET_SHIFT) + 1;
+    infan_bucket = (int (*)[MAX_INFANTRY]) level_alloc(infan_buckets * sizeof(*infan_bucket));
+    infan_bucket_count = (int *) level_alloc(infan_buckets * sizeof(int));
+    struct_bucket = (int (*)[MAX_STRUCTURES]) level_alloc(infan_buckets * sizeof(*struct_bucket));
+    struct_bucket_count = (int *) level_alloc(infan_buckets * sizeof(int));
+
+    for (b = 0; b < infan_buckets; b++)
+        struct_bucket_count[b] = 0;
+
+    for (l = 0; l < MAX_STRUCTURES; l++) {
+        if (structures[l][1] == NULL)
+            continue;
+
+        for (b = infan_bucket_of(leveldata.struct_x[l]); b <= infan_bucket_of(leveldata.struct_x[l] + struct_width[l]); b++)
+            struct_bucket[b][struct_bucket_count[b]++] = l;
+    }
+}
+
+void build_infan_buckets(void) {
+    int l, b;
+
+    for (b = 0; b < infan_buckets; b++)
+        infan_bucket_count[b] = 0;
+
+    for (l = 0; l < MAX_INFANTRY; l++) {
+        if (!infan_x[l])
+            continue;
+
+        b = infan_bucket_of(infan_x[l]);
+        infan_bucket[b][infan_bucket_count[b]++] = l;
+    }
+}
+
 void infan_to_plane(int l) {
     int l2;
     int angle;
@@ -761,23 +832,36 @@ void infan_to_plane(int l) {
 }
 
 void infan_to_infan(int l) {
-    int l2;
+    int l2, b, c, candidate;
     int angle;
     int distance;
 
-    for (l2 = 0; l2 < MAX_INFANTRY; l2++) {
-        if (!infan_x[l2])
-            continue;
+    // First soldier in index order that qualifies, as a full scan would find
+    l2 = MAX_INFANTRY;
+    for (b = infan_bucket_of(infan_x[l] - 50 - INFAN_MAX_STEP); b <= infan_bucket_of(infan_x[l] + 50 + INFAN_MAX_STEP); b++) {
+        for (c = 0; c < infan_bucket_count[b]; c++) {
+            candidate = infan_bucket[b][c];
 
-        if (infan_country[l2] == infan_country[l])
-            continue;
+            if (candidate >= l2)
+                break;
 
-        if (player_sides[infan_country[l]] == player_sides[infan_country[l2]])
-            continue;
+            if (!infan_x[candidate])
+                continue;
 
-        if (abs(infan_x[l2] - infan_x[l]) > 50)
-            continue;
+            if (infan_country[candidate] == infan_country[l])
+                continue;
+
+            if (player_sides[infan_country[l]] == player_sides[infan_country[candidate]])
+                continue;
+
+            if (abs(infan_x[candidate] - infan_x[l]) > 50)
+                continue;
 
+            l2 = candidate;
+        }
+    }
+
+    if (l2 != MAX_INFANTRY) {
         calculate_difference(infan_x[l] + 7, infan_y[l] + 7, infan_x[l2] + 7, infan_y[l2] + 7, &distance, &angle);
 
 
@@ -817,17 +901,13 @@ void infan_to_infan(int l) {
             }
 
         }
-
-
-        break;
     }
-
-
 }
 
 
 void infan_to_struct(int l) {
-    int l2;
+    int l2, b, c, i, count, first_bucket;
+    int candidates[MAX_STRUCTURES];
     ///
     for (l2 = 0; l2 < MAX_AA_GUNS; l2++)
         if (kkbase_x[l2] && kkbase_status[l2] != 2 && (leveldata.struct_owner[kkbase_number[l2]] != 4)
@@ -855,7 +935,26 @@ void infan_to_struct(int l) {
             }
         }
 
-    for (l2 = 0; l2 < MAX_STRUCTURES; l2++)
+    // Structures touching the soldier, in index order and without duplicates
+    count = 0;
+    first_bucket = infan_bucket_of(infan_x[l]);
+    for (b = first_bucket; b <= infan_bucket_of(infan_x[l] + 15); b++)
+        for (c = 0; c < struct_bucket_count[b]; c++) {
+            l2 = struct_bucket[b][c];
+
+            if (b > first_bucket && infan_bucket_of(leveldata.struct_x[l2]) < b)
+                continue;
+
+            for (i = count; i > 0 && candidates[i - 1] > l2; i--)
+                candidates[i] = candidates[i - 1];
+
+            candidates[i] = l2;
+            count++;
+        }
+
+    for (c = 0; c < count; c++) {
+        l2 = candidates[c];
+
         if ((structures[l2][1] != NULL) && (leveldata.struct_owner[l2] != 4) && (player_sides[leveldata.struct_owner[l2]] != player_sides[infan_country[l]])
             && (!struct_state[l2])) {
             if (infan_x[l] + 15 >= leveldata.struct_x[l2] && infan_x[l] <= (leveldata.struct_x[l2] + struct_width[l2])) {
@@ -894,7 +993,7 @@ void infan_to_struct(int l) {
 
             }
         }
-
+    }
 }
 
 
@@ -958,6 +1057,8 @@ void do_infan(void) {
     int distance;
     int diff;
 
+    build_infan_buckets();
+
     for (l = 0; l < MAX_INFANTRY; l++) {
         if (!infan_x[l])
             continue;
@@ -1033,7 +1134,7 @@ void do_infan(void) {
 
         } else {
             infan_x[l] += (infan_direction[l] ? 1 : -1);
-            if (infan_x[l] >= 2400)
+            if (infan_x[l] >= level_width)
                 infan_x[l] = 0;
 
         }
@@ -1154,10 +1255,29 @@ void do_kkbase(void) {
 
 }
 
+/*
+ * Direction of travel of a plane, derived from its angle. Kept out of
+ * globals so that deciding one plane's controls does not depend on
+ * which plane was handled before it.
+ */
+static int ai_going_left(int number) {
+    return (player_angle[number] <= 69120) && (player_angle[number] > 23040);
+}
+
+static int ai_going_up(int number) {
+    if (player_angle[number] >= 46080)
+        return 0;
+
+    if (player_angle[number] > 23040)
+        return 46080 - player_angle[number];
+
+    return player_angle[number];
+}
+
 void ai_turn_down(int number) {
     int flaggy;
 
-    if (going_left)
+    if (ai_going_left(number))
         flaggy = 1;
     else
         flaggy = 0;
@@ -1173,7 +1293,7 @@ void ai_turn_down(int number) {
 void ai_turn_up(int number) {
     int flaggy;
 
-    if (going_left)
+    if (ai_going_left(number))
         flaggy = 1;
     else
         flaggy = 0;
@@ -1187,11 +1307,12 @@ void ai_turn_up(int number) {
 
 void ai_evade_terrain(int number) {
     int x_kohta, y_kohta;
+    int going_up = ai_going_up(number);
 
     x_kohta = ((((player_x_speed[number] * AVOID_TERRAIN_FRAMES) >> 8) + player_x[number]) >> 8);
     y_kohta = ((player_y[number] - ((player_y_speed[number] * AVOID_TERRAIN_FRAMES) >> 8)) >> 8) + PLANE_MODIFICATION * 2;
-    if (x_kohta >= 2400)
-        x_kohta = 2399;
+    if (x_kohta >= level_width)
+        x_kohta = level_width - 1;
     if (y_kohta >= 200)
         y_kohta = 199;
     if (x_kohta < 0)
@@ -1238,8 +1359,51 @@ void ai_turnminus(int number) {
     controls_down[number] = flaggy ? 0 : 1;
 }
 
+/*
+ * Distance and angle from every computer plane to the lead-compensated
+ * position of every other plane, computed once per frame before the
+ * computer planes are run. Nothing in do_ai() moves planes, so this
+ * gives the same results as calling calculate_difference() from each
+ * do_ai().
+ */
+void ai_plane_geometry(void) {
+    int number, flaggy;
+    int target_x[16], target_y[16];
+
+    for (flaggy = 0; flaggy < 16; flaggy++) {
+        target_x[flaggy] = (player_x[flaggy] + (player_x_speed[flaggy] >> 7)) >> 8;
+        target_y[flaggy] = (player_y[flaggy] - (player_y_speed[flaggy] >> 7)) >> 8;
+    }
+
+    for (number = 0; number < 16; number++) {
+        if (!player_exists[number] || !computer_active[number])
+            continue;
+
+        for (flaggy = 0; flaggy < 16; flaggy++) {
+            if (flaggy == number)
+                continue;
+
+            if (!player_exists[flaggy])
+                continue;
+
+            calculate_difference(player_x_8[number], player_y_8[number], target_x[flaggy], target_y[flaggy],
+                                 &ai_distance[number][flaggy], &ai_angle[number][flaggy]);
+        }
+    }
+}
 
+/*
+ * Decide the controls of computer plane number. This runs serially,
+ * one plane after another, and draws from the shared wrandom() stream.
+ * Recordings (record.dta) store only the human players' controls and
+ * the wrandom() value of each frame; the computer planes are decided
+ * again on playback. Giving the AI its own random streams or running
+ * it in a different order would change that sequence and make every
+ * existing recording report "Random failure". Do not change either
+ * without also changing the recording format.
+ */
 void do_ai(int number) {
+    int going_left, going_up;
     int xdistance, ydistance;
     int distance_enemy[16], angle_enemy[16], angle_difference[16];
     int flaggy;
@@ -1256,9 +1420,8 @@ void do_ai(int number) {
         if (!player_exists[flaggy])
             continue;
 
-        //calculate_difference(player_x[number]>>8,player_y_8[number]>>8,(player_x[flaggy]>>8),(player_y[flaggy]>>8),&distance_enemy[flaggy],&angle_enemy[flaggy]);     
-        calculate_difference(player_x_8[number], player_y_8[number], ((player_x[flaggy] + (player_x_speed[flaggy] >> 7)) >> 8),
-                             ((player_y[flaggy] - (player_y_speed[flaggy] >> 7)) >> 8), &distance_enemy[flaggy], &angle_enemy[flaggy]);
+        distance_enemy[flaggy] = ai_distance[number][flaggy];
+        angle_enemy[flaggy] = ai_angle[number][flaggy];
 
         angle_difference[flaggy] = abs((player_angle[number] >> 8) - angle_enemy[flaggy]);
         if (angle_difference[flaggy] > 180) {
@@ -1267,17 +1430,8 @@ void do_ai(int number) {
     }
 
 
-    if ((player_angle[number] <= 69120) && (player_angle[number] > 23040))
-        going_left = 1;
-    else
-        going_left = 0;
-
-    if ((player_angle[number] < 46080)) {
-        going_up = player_angle[number];
-        if (going_up > 23040)
-            going_up = 46080 - going_up;
-    } else
-        going_up = 0;
+    going_left = ai_going_left(number);
+    going_up = ai_going_up(number);
 
     controls_down[number] = 0;
     controls_up[number] = 0;
@@ -1636,7 +1790,7 @@ void do_ai(int number) {
             }
 
         if ((player_x_8[number] < (120 + ((player_speed[number]) / 40)) && going_left) ||
-            (player_x_8[number] > (2280 - ((player_speed[number]) / 40)) && !going_left)) {
+            (player_x_8[number] > (level_width - 120 - ((player_speed[number]) / 40)) && !going_left)) {
             if ((wide_terrain_level[player_x_8[number]] - (player_y_8[number])) > ((player_y_8[number]) + 15))
                 current_mission[number] = AIM_SPLITS;
             else
@@ -1654,7 +1808,7 @@ void do_ai(int number) {
     case AIM_EVADE_TERRAIN:
 
         if ((player_x[number] < (80 + (player_speed[number] >> 5)) * 256 && going_left) ||
-            (player_x[number] > (2320 - (player_speed[number] >> 5)) * 256 && !going_left)) {
+            (player_x[number] > (level_width - 80 - (player_speed[number] >> 5)) * 256 && !going_left)) {
             if ((wide_terrain_level[player_x_8[number]] - (player_y_8[number])) > ((player_y_8[number]) + 15))
                 current_mission[number] = AIM_SPLITS;
             else
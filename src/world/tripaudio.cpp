@@ -64,6 +64,8 @@ void itgun_sound(int itgun_x) {
 void load_all_samples(void) {
     int l;
 
+    sdl_sample_store_begin();
+
     sample_itexp[0] = sample_load("Itexp1");
     sample_itexp[0]->left_volume = SAMPLE_VOLUME;
     sample_itexp[0]->right_volume = SAMPLE_VOLUME;
@@ -169,7 +171,22 @@ void load_all_samples(void) {
     for (l = 0; l < 9; l++) {
         sample_die[l]->left_volume = SAMPLE_VOLUME - 8;
         sample_die[l]->right_volume = SAMPLE_VOLUME - 8;
+        sample_die[l]->priority = SAMPLE_PRIORITY_LOW;
+    }
+
+    for (l = 0; l < 3; l++) {
+        sample_splash[l]->priority = SAMPLE_PRIORITY_LOW;
+        sample_itexp[l]->priority = SAMPLE_PRIORITY_HIGH;
+        sample_bomb[l + 1]->priority = SAMPLE_PRIORITY_HIGH;
     }
+
+    sample_crash[0]->priority = SAMPLE_PRIORITY_HIGH;
+    sample_crash[1]->priority = SAMPLE_PRIORITY_HIGH;
+    sample_spcrash->priority = SAMPLE_PRIORITY_HIGH;
+    sample_alku->priority = SAMPLE_PRIORITY_HIGH;
+    sample_hurr->priority = SAMPLE_PRIORITY_HIGH;
+
+    sdl_sample_store_end();
 }
 
 void load_sfx(void) {
@@ -218,6 +235,8 @@ void clear_sfx(void) {
 
 
     }
+
+    sdl_sample_store_free();
 }
 
 